@@ -0,0 +1,477 @@
+/********************************************************************************
+ * @file           : fsmBench.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Benchmark of the FSM dispatch cost
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Measures the cost of one fsmRun() call for:
+ *   - steady state (no transition)
+ *   - transition on every call, without and with entry / exit functions
+ *   - transition on every call through tables of different size
+ *   - thousands of instances with their own tables (cache cold tables,
+ *     plain state table layout, see README "State table layout")
+ *   - thousands of instances of one table, one by one and as batch (fsmBatch.h)
+ *
+ * Host build (ns per call, plus cycles per call on x86):
+ *
+ *     gcc -O2 -I. bench/fsmBench.c fsm.c fsmBatch.c -o fsmBench
+ *     ./fsmBench
+ *
+ * Bare-metal build (Cortex-M3/M4/M7, cycles per call from DWT->CYCCNT):
+ * compile the same files with -DFSM_BENCH_BARE_METAL into the firmware,
+ * retarget printf (UART, RTT or semihosting) and call fsmBenchMain().
+ * FSM_BENCH_ITERATIONS and FSM_BENCH_NR_OF_INSTANCES can be reduced
+ * to fit the target.
+ *
+ * Build options can be passed to compare configurations, the active
+ * configuration is printed with the results. Some options need an extra
+ * source file:
+ *
+ *     -DFSM_CHECK_NEXT_STATE=0
+ *     -DFSM_PROFILING=1  fsmProfile.c
+ *     -DFSM_TRACE=1      fsmTrace.c
+ *     -DFSM_EXPORT=1     fsmExport.c
+ *
+ * The bench implements the cycle counter and the timestamps these options
+ * read (fsmProfileCycles(), fsmTraceTimestamp(), fsmExportTimestamp()).
+ * No profile, trace sink or export slot is attached, so the results show
+ * the cost of the compiled in hooks.
+ *
+ ********************************************************************************/
+
+#ifndef FSM_BENCH_BARE_METAL
+#define _POSIX_C_SOURCE 199309L /* clock_gettime() */
+#endif
+
+#include "fsm.h"
+#include "fsmBatch.h"
+#include "stdio.h"
+#include "stddef.h"
+
+#ifndef FSM_BENCH_ITERATIONS
+#ifdef FSM_BENCH_BARE_METAL
+#define FSM_BENCH_ITERATIONS  10000UL
+#else
+#define FSM_BENCH_ITERATIONS  10000000UL
+#endif
+#endif
+
+#ifndef FSM_BENCH_NR_OF_INSTANCES
+#ifdef FSM_BENCH_BARE_METAL
+#define FSM_BENCH_NR_OF_INSTANCES  32U
+#else
+#define FSM_BENCH_NR_OF_INSTANCES  4096U
+#endif
+#endif
+
+#define FSM_BENCH_MAX_NR_OF_STATES  255U
+#define FSM_BENCH_COLD_NR_OF_STATES  16U
+
+/******************************************************************************
+ * Time measurement
+ ******************************************************************************/
+
+#ifdef FSM_BENCH_BARE_METAL
+
+#define FSM_BENCH_DEMCR       (*(volatile uint32_t*)0xE000EDFCUL)
+#define FSM_BENCH_DWT_CTRL    (*(volatile uint32_t*)0xE0001000UL)
+#define FSM_BENCH_DWT_CYCCNT  (*(volatile uint32_t*)0xE0001004UL)
+
+typedef uint32_t FsmBenchTime_t;
+
+static void fsmBenchTimeInit(void)
+{
+    FSM_BENCH_DEMCR |= (1UL << 24);     /* TRCENA */
+    FSM_BENCH_DWT_CYCCNT = 0;
+    FSM_BENCH_DWT_CTRL |= 1UL;          /* CYCCNTENA */
+}
+
+static FsmBenchTime_t fsmBenchTimeNow(void)
+{
+    return FSM_BENCH_DWT_CYCCNT;
+}
+
+static void fsmBenchPrintResult(const char* name, FsmBenchTime_t start, FsmBenchTime_t end, uint32_t calls)
+{
+    printf("%-44s %8lu cycles/call\r\n", name, (unsigned long)((end - start) / calls));
+}
+
+#if (FSM_PROFILING != 0) || (FSM_TRACE != 0) || (FSM_EXPORT != 0)
+static uint32_t fsmBenchCounter(void)
+{
+    return FSM_BENCH_DWT_CYCCNT;
+}
+#endif
+
+#else
+
+#include "time.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include "x86intrin.h"
+#define FSM_BENCH_HAS_TSC
+#endif
+
+typedef struct
+{
+    uint64_t ns;
+    uint64_t cycles;
+} FsmBenchTime_t;
+
+static void fsmBenchTimeInit(void)
+{
+}
+
+static FsmBenchTime_t fsmBenchTimeNow(void)
+{
+    FsmBenchTime_t now;
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now.ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#ifdef FSM_BENCH_HAS_TSC
+    now.cycles = __rdtsc();
+#else
+    now.cycles = 0;
+#endif
+    return now;
+}
+
+static void fsmBenchPrintResult(const char* name, FsmBenchTime_t start, FsmBenchTime_t end, uint32_t calls)
+{
+    double ns = (double)(end.ns - start.ns) / calls;
+#ifdef FSM_BENCH_HAS_TSC
+    double cycles = (double)(end.cycles - start.cycles) / calls;
+
+    printf("%-44s %8.2f ns/call %8.2f TSC cycles/call\n", name, ns, cycles);
+#else
+    printf("%-44s %8.2f ns/call\n", name, ns);
+#endif
+}
+
+#if (FSM_PROFILING != 0) || (FSM_TRACE != 0) || (FSM_EXPORT != 0)
+static uint32_t fsmBenchCounter(void)
+{
+#ifdef FSM_BENCH_HAS_TSC
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec);
+#endif
+}
+#endif
+
+#endif
+
+/* counters read by the fsm module with the profiling, trace and export options */
+#if (FSM_PROFILING != 0)
+uint32_t fsmProfileCycles(void)
+{
+    return fsmBenchCounter();
+}
+#endif
+
+#if (FSM_TRACE != 0)
+uint32_t fsmTraceTimestamp(void)
+{
+    return fsmBenchCounter();
+}
+#endif
+
+#if (FSM_EXPORT != 0)
+uint32_t fsmExportTimestamp(void)
+{
+    return fsmBenchCounter();
+}
+#endif
+
+/******************************************************************************
+ * State functions
+ ******************************************************************************/
+
+static volatile uint32_t fsmBenchSink;
+
+static uint8_t fsmBenchStay(void* context, const FsmEvent_t event)
+{
+    (void)context;
+    (void)event;
+    return 0;
+}
+
+/* cyclic machine, the handle is the context: every call goes to the next state */
+static uint8_t fsmBenchNext(void* context, const FsmEvent_t event)
+{
+    const FsmHandle_t* fsmHandle = (const FsmHandle_t*)context;
+    uint8_t stateNext = (uint8_t)(fsmHandle->currentState + 1U);
+
+    (void)event;
+    return (stateNext < fsmHandle->def->nrOfStates) ? stateNext : 0;
+}
+
+/* cyclic machine, the context is a per instance counter */
+static uint8_t fsmBenchCount(void* context, const FsmEvent_t event)
+{
+    uint32_t* counter = (uint32_t*)context;
+
+    (void)event;
+    (*counter)++;
+    return (uint8_t)(*counter % FSM_BENCH_COLD_NR_OF_STATES);
+}
+
+static void fsmBenchEntry(void* context)
+{
+    (void)context;
+    fsmBenchSink++;
+}
+
+static void fsmBenchExit(void* context)
+{
+    (void)context;
+    fsmBenchSink++;
+}
+
+/******************************************************************************
+ * Benchmarks
+ ******************************************************************************/
+
+static FsmStateDef_t fsmBenchTable[FSM_BENCH_MAX_NR_OF_STATES];
+static FsmDef_t fsmBenchDef;
+
+static FsmStateDef_t fsmBenchColdTables[FSM_BENCH_NR_OF_INSTANCES][FSM_BENCH_COLD_NR_OF_STATES];
+static FsmDef_t fsmBenchColdDefs[FSM_BENCH_NR_OF_INSTANCES];
+static FsmHandle_t fsmBenchColdHandles[FSM_BENCH_NR_OF_INSTANCES];
+
+/* instances of the batch benchmark, all of them share one table */
+static uint32_t fsmBenchCounters[FSM_BENCH_NR_OF_INSTANCES];
+static void* fsmBenchContexts[FSM_BENCH_NR_OF_INSTANCES];
+static uint8_t fsmBenchStates[FSM_BENCH_NR_OF_INSTANCES];
+static uint32_t fsmBenchOrder[FSM_BENCH_NR_OF_INSTANCES];
+static void* fsmBenchGroupContexts[FSM_BENCH_NR_OF_INSTANCES];
+static uint8_t fsmBenchNextStates[FSM_BENCH_NR_OF_INSTANCES];
+static FsmBatch_t fsmBenchBatch;
+
+static void fsmBenchDefInit(FsmDef_t* fsmDef, FsmStateDef_t* table, const uint8_t nrOfStates,
+                            FsmOnEntryFunc_t* onEntryFunc, FsmOnExitFunc_t* onExitFunc)
+{
+    fsmDefInit(fsmDef, table, nrOfStates);
+    for (uint8_t state = 0; state < nrOfStates; state++)
+    {
+        fsmAdd(fsmDef, state, fsmBenchNext, onEntryFunc, onExitFunc, 0);
+    }
+}
+
+static void fsmBenchRun(const char* name, FsmHandle_t* fsmHandle)
+{
+    FsmBenchTime_t start;
+    FsmBenchTime_t end;
+
+    /* warm up */
+    for (uint32_t i = 0; i < (FSM_BENCH_ITERATIONS / 10U); i++)
+    {
+        fsmRun(fsmHandle);
+    }
+
+    start = fsmBenchTimeNow();
+    for (uint32_t i = 0; i < FSM_BENCH_ITERATIONS; i++)
+    {
+        fsmRun(fsmHandle);
+    }
+    end = fsmBenchTimeNow();
+
+    fsmBenchPrintResult(name, start, end, FSM_BENCH_ITERATIONS);
+}
+
+static void fsmBenchSteadyState(void)
+{
+    static const FsmStateDef_t table[] =
+    {
+        { fsmBenchStay, fsmBenchEntry, fsmBenchExit, 0, FSM_STATE_BUDGET(0U) },
+    };
+    static const FsmDef_t fsmDef = FSM_DEF_INIT(table);
+    FsmHandle_t fsmHandle;
+
+    fsmInit(&fsmHandle, &fsmDef, 0, NULL);
+    fsmBenchRun("steady state (no transition)", &fsmHandle);
+}
+
+static void fsmBenchTransition(void)
+{
+    FsmHandle_t fsmHandle;
+
+    fsmBenchDefInit(&fsmBenchDef, fsmBenchTable, 2, NULL, NULL);
+    fsmInit(&fsmHandle, &fsmBenchDef, 0, &fsmHandle);
+    fsmBenchRun("transition every call", &fsmHandle);
+
+    fsmBenchDefInit(&fsmBenchDef, fsmBenchTable, 2, fsmBenchEntry, fsmBenchExit);
+    fsmInit(&fsmHandle, &fsmBenchDef, 0, &fsmHandle);
+    fsmBenchRun("transition every call, entry + exit", &fsmHandle);
+}
+
+static void fsmBenchTableSize(void)
+{
+    static const uint8_t nrOfStates[] = { 2U, 16U, 64U, 255U };
+    char name[48];
+    FsmHandle_t fsmHandle;
+
+    for (uint8_t i = 0; i < (uint8_t)(sizeof(nrOfStates) / sizeof(nrOfStates[0])); i++)
+    {
+        fsmBenchDefInit(&fsmBenchDef, fsmBenchTable, nrOfStates[i], fsmBenchEntry, fsmBenchExit);
+        fsmInit(&fsmHandle, &fsmBenchDef, 0, &fsmHandle);
+        snprintf(name, sizeof(name), "transition every call, %u states", (unsigned)nrOfStates[i]);
+        fsmBenchRun(name, &fsmHandle);
+    }
+}
+
+/* Every instance has its own table in the plain FsmStateDef_t layout, 2 MiB
+ * of tables on a 64 bit host. The hot / cold split measured with this
+ * scenario is described in the README (State table layout). */
+static void fsmBenchColdInstances(const char* variant, FsmOnEntryFunc_t* onEntryFunc, FsmOnExitFunc_t* onExitFunc)
+{
+    FsmBenchTime_t start;
+    FsmBenchTime_t end;
+    char name[48];
+    uint32_t rounds = FSM_BENCH_ITERATIONS / FSM_BENCH_NR_OF_INSTANCES;
+    uint32_t index = 0;
+
+    if (0 == rounds)
+    {
+        rounds = 1;
+    }
+
+    for (uint32_t i = 0; i < FSM_BENCH_NR_OF_INSTANCES; i++)
+    {
+        fsmBenchDefInit(&fsmBenchColdDefs[i], fsmBenchColdTables[i], FSM_BENCH_COLD_NR_OF_STATES, onEntryFunc, onExitFunc);
+        fsmInit(&fsmBenchColdHandles[i], &fsmBenchColdDefs[i], (uint8_t)(i % FSM_BENCH_COLD_NR_OF_STATES), &fsmBenchColdHandles[i]);
+    }
+
+    /* visit the instances in a scattered order (odd stride), so neighbouring handles are not prefetched */
+    start = fsmBenchTimeNow();
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        for (uint32_t i = 0; i < FSM_BENCH_NR_OF_INSTANCES; i++)
+        {
+            index = (index + 613U) % FSM_BENCH_NR_OF_INSTANCES;
+            fsmRun(&fsmBenchColdHandles[index]);
+        }
+    }
+    end = fsmBenchTimeNow();
+
+    snprintf(name, sizeof(name), "%u instances, own tables%s", (unsigned)FSM_BENCH_NR_OF_INSTANCES, variant);
+    fsmBenchPrintResult(name, start, end, rounds * FSM_BENCH_NR_OF_INSTANCES);
+}
+
+static void fsmBenchBatchInstances(void)
+{
+    FsmBenchTime_t start;
+    FsmBenchTime_t end;
+    char name[48];
+    uint32_t rounds = FSM_BENCH_ITERATIONS / FSM_BENCH_NR_OF_INSTANCES;
+
+    if (0 == rounds)
+    {
+        rounds = 1;
+    }
+
+    fsmDefInit(&fsmBenchDef, fsmBenchTable, FSM_BENCH_COLD_NR_OF_STATES);
+    for (uint8_t state = 0; state < FSM_BENCH_COLD_NR_OF_STATES; state++)
+    {
+        fsmAdd(&fsmBenchDef, state, fsmBenchCount, fsmBenchEntry, fsmBenchExit, 0);
+    }
+
+    /* one by one, the handles are reused to save memory */
+    for (uint32_t i = 0; i < FSM_BENCH_NR_OF_INSTANCES; i++)
+    {
+        fsmBenchCounters[i] = i;
+        fsmInit(&fsmBenchColdHandles[i], &fsmBenchDef, (uint8_t)(i % FSM_BENCH_COLD_NR_OF_STATES), &fsmBenchCounters[i]);
+    }
+
+    start = fsmBenchTimeNow();
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        for (uint32_t i = 0; i < FSM_BENCH_NR_OF_INSTANCES; i++)
+        {
+            fsmRun(&fsmBenchColdHandles[i]);
+        }
+    }
+    end = fsmBenchTimeNow();
+
+    snprintf(name, sizeof(name), "%u instances, shared table", (unsigned)FSM_BENCH_NR_OF_INSTANCES);
+    fsmBenchPrintResult(name, start, end, rounds * FSM_BENCH_NR_OF_INSTANCES);
+
+    for (uint32_t i = 0; i < FSM_BENCH_NR_OF_INSTANCES; i++)
+    {
+        fsmBenchCounters[i] = i;
+        fsmBenchContexts[i] = &fsmBenchCounters[i];
+    }
+    fsmBatchInit(&fsmBenchBatch, &fsmBenchDef, fsmBenchStates, fsmBenchContexts, FSM_BENCH_NR_OF_INSTANCES, 0);
+    fsmBatchSetBuffers(&fsmBenchBatch, fsmBenchOrder, fsmBenchGroupContexts, fsmBenchNextStates);
+    for (uint32_t i = 0; i < FSM_BENCH_NR_OF_INSTANCES; i++)
+    {
+        fsmBenchStates[i] = (uint8_t)(i % FSM_BENCH_COLD_NR_OF_STATES);
+    }
+
+    start = fsmBenchTimeNow();
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        fsmBatchRun(&fsmBenchBatch);
+    }
+    end = fsmBenchTimeNow();
+
+    snprintf(name, sizeof(name), "%u instances, shared table, batch", (unsigned)FSM_BENCH_NR_OF_INSTANCES);
+    fsmBenchPrintResult(name, start, end, rounds * FSM_BENCH_NR_OF_INSTANCES);
+}
+
+/**
+ * @brief Run all benchmarks and print the results.
+ *
+ * @return 0
+ */
+int fsmBenchMain(void)
+{
+    fsmBenchTimeInit();
+
+    printf("fsm benchmark: FSM_CHECK_NEXT_STATE=%d FSM_PROFILING=%d FSM_TRACE=%d FSM_EXPORT=%d, %lu iterations\n",
+           FSM_CHECK_NEXT_STATE, FSM_PROFILING, FSM_TRACE, FSM_EXPORT, (unsigned long)FSM_BENCH_ITERATIONS);
+
+    fsmBenchSteadyState();
+    fsmBenchTransition();
+    fsmBenchTableSize();
+    fsmBenchColdInstances("", fsmBenchEntry, fsmBenchExit);
+    fsmBenchColdInstances(", no entry / exit", NULL, NULL);
+    fsmBenchBatchInstances();
+
+    return 0;
+}
+
+#ifndef FSM_BENCH_BARE_METAL
+int main(void)
+{
+    return fsmBenchMain();
+}
+#endif
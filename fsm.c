@@ -30,30 +30,314 @@
  ********************************************************************************/
 
 #include "fsm.h"
+#include "fsmTimer.h"
+#include "fsmProfile.h"
+#include "fsmTrace.h"
+#include "fsmExport.h"
 #include "stddef.h"
 
+#if defined(__GNUC__) || defined(__clang__)
+#define FSM_UNLIKELY(x)  __builtin_expect(!!(x), 0)
+#else
+#define FSM_UNLIKELY(x)  (x)
+#endif
+
+/**
+ * @brief Bind a user provided state table to the fsm definition and clear it.
+ *        Should be called first if the definition is filled at runtime
+ *        with fsmAdd(). Not needed for const definitions (see FSM_DEF_INIT()).
+ *
+ * @param fsmDef - fsm definition
+ * @param table - state table with nrOfStates items
+ * @param nrOfStates - number of states of the fsm (1 - 255)
+ * @return  0 - definition initialized
+ *         -1 - invalid table or number of states
+ */
+int8_t fsmDefInit(FsmDef_t* fsmDef, FsmStateDef_t* table, const uint8_t nrOfStates)
+{
+    int8_t defInitialized = -1;
+
+    fsmDef->table = table;
+    fsmDef->transitions = NULL;
+    fsmDef->transitionIndex = NULL;
+    fsmDef->nrOfStates = 0;
+    fsmDef->errorFunc = NULL;
+    fsmDef->parents = NULL;
+    fsmDef->lca = NULL;
+    fsmDef->coalesceMask = NULL;
+    fsmDef->inputGuards = NULL;
+
+    if ((NULL != table) && (nrOfStates > 0))
+    {
+        for (uint8_t i = 0; i < nrOfStates; i++)
+        {
+            table[i].stateFunc = NULL;
+            table[i].onEntryFunc = NULL;
+            table[i].onExitFunc = NULL;
+            table[i].timeout = 0;
+#if (FSM_PROFILING != 0)
+            table[i].budget = 0;
+#endif
+        }
+        fsmDef->nrOfStates = nrOfStates;
+        defInitialized = 0;
+    }
+    return defInitialized;
+}
+
+/**
+ * @brief Register a state to the fsm definition.
+ *
+ * @param fsmDef - fsm definition
+ * @param state - state index
+ * @param stateFunc - function pointer that is called if state is executed,
+ *                    may be NULL if the state is handled by the transition table
+ * @param onEntryFunc - function pointer that is called when entering a new state
+ * @param onExitFunc - function pointer that is called when leaving a state
+ * @param timeout - state timeout in timer ticks, 0 = no timeout
+ * @return  0 - state added successfully
+ *         -1 - state could not be added
+ */
+int8_t fsmAdd(FsmDef_t* fsmDef, const uint8_t state, FsmStateFunc_t stateFunc, FsmOnEntryFunc_t onEntryFunc, FsmOnExitFunc_t onExitFunc, const uint32_t timeout)
+{
+    int8_t stateAdded = -1;
+
+    if (state < fsmDef->nrOfStates)
+    {
+        /* table is writable, it was handed in by fsmDefInit() */
+        FsmStateDef_t* table = (FsmStateDef_t*)fsmDef->table;
+
+        table[state].stateFunc = stateFunc;
+        table[state].onEntryFunc = onEntryFunc;
+        table[state].onExitFunc = onExitFunc;
+        table[state].timeout = timeout;
+        stateAdded = 0;
+    }
+    return stateAdded;
+}
+
+#if (FSM_PROFILING != 0)
+/**
+ * @brief Set the cycle budget of a state added with fsmAdd(). Every
+ *        execution of the state function that takes longer is counted as
+ *        overrun of the profile (see fsmProfile.h).
+ *
+ * @param fsmDef - fsm definition, initialized with fsmDefInit()
+ * @param state - state index
+ * @param budget - max cycles of the state function, 0 = no budget
+ * @return  0 - budget set
+ *         -1 - invalid state
+ */
+int8_t fsmDefSetBudget(FsmDef_t* fsmDef, const uint8_t state, const uint32_t budget)
+{
+    int8_t budgetSet = -1;
+
+    if (state < fsmDef->nrOfStates)
+    {
+        /* table is writable, it was handed in by fsmDefInit() */
+        FsmStateDef_t* table = (FsmStateDef_t*)fsmDef->table;
+
+        table[state].budget = budget;
+        budgetSet = 0;
+    }
+    return budgetSet;
+}
+#endif
+
 /**
- * @brief Set the init state of the FSM (state that is executed first).
- *        Should be called first to initialize the  fsm table and set
- *        the initial state.
+ * @brief Add a transition table to the fsm definition and build the
+ *        per state transition index. Transitions must be sorted by state,
+ *        entries of the same state are checked in table order.
+ *
+ * @param fsmDef - fsm definition, table and number of states must be set
+ * @param transitions - transition table with nrOfTransitions items
+ * @param nrOfTransitions - number of transitions
+ * @param transitionIndex - [out] index array with nrOfStates + 1 items
+ * @return  0 - transitions added successfully
+ *         -1 - transitions are not sorted or contain invalid states
+ */
+int8_t fsmDefSetTransitions(FsmDef_t* fsmDef, const FsmTransition_t* transitions, const uint16_t nrOfTransitions, uint16_t* transitionIndex)
+{
+    int8_t transitionsAdded = 0;
+    uint16_t i = 0;
+
+    for (uint16_t state = 0; state <= fsmDef->nrOfStates; state++)
+    {
+        transitionIndex[state] = i;
+
+        while ((i < nrOfTransitions) && (transitions[i].state == state))
+        {
+            if (transitions[i].nextState >= fsmDef->nrOfStates)
+            {
+                transitionsAdded = -1;
+            }
+            i++;
+        }
+    }
+
+    if ((i != nrOfTransitions) || (0 != transitionsAdded))
+    {
+        /* unsorted or invalid state, keep the definition without transitions */
+        transitionsAdded = -1;
+    }
+    else
+    {
+        fsmDef->transitions = transitions;
+        fsmDef->transitionIndex = transitionIndex;
+    }
+    return transitionsAdded;
+}
+
+/**
+ * @brief Set the function that is called if a state function returns an
+ *        invalid next state (see FSM_CHECK_NEXT_STATE).
+ *
+ * @param fsmDef - fsm definition
+ * @param errorFunc - error function, returns the state to go to instead,
+ *                    NULL to stay in the current state
+ */
+void fsmDefSetErrorFunc(FsmDef_t* fsmDef, FsmErrorFunc_t* errorFunc)
+{
+    fsmDef->errorFunc = errorFunc;
+}
+
+/**
+ * @brief Add a state hierarchy to the fsm definition and precompute the
+ *        least common ancestor of every pair of states, so transitions
+ *        do not need to search the tree at runtime.
+ *
+ * @param fsmDef - fsm definition, table and number of states must be set
+ * @param parents - parent of every state (nrOfStates items), FSM_NO_PARENT for top level states
+ * @param lca - [out] least common ancestor table with nrOfStates * nrOfStates items
+ * @return  0 - hierarchy added successfully
+ *         -1 - invalid parent, cycle or hierarchy deeper than FSM_MAX_DEPTH
+ */
+int8_t fsmDefSetHierarchy(FsmDef_t* fsmDef, const uint8_t* parents, uint8_t* lca)
+{
+    int8_t hierarchyAdded = 0;
+    uint16_t nrOfStates = fsmDef->nrOfStates;
+
+    for (uint16_t state = 0; (state < nrOfStates) && (0 == hierarchyAdded); state++)
+    {
+        uint8_t ancestor = parents[state];
+        uint8_t depth = 1;
+
+        while ((FSM_NO_PARENT != ancestor) && (0 == hierarchyAdded))
+        {
+            depth++;
+            if ((ancestor >= nrOfStates) || (depth > FSM_MAX_DEPTH))
+            {
+                hierarchyAdded = -1; /* invalid parent or cycle */
+            }
+            else
+            {
+                ancestor = parents[ancestor];
+            }
+        }
+    }
+
+    for (uint16_t a = 0; (a < nrOfStates) && (0 == hierarchyAdded); a++)
+    {
+        for (uint16_t b = 0; b < nrOfStates; b++)
+        {
+            uint8_t common = FSM_NO_PARENT;
+
+            for (uint8_t ancestorA = (uint8_t)a; (FSM_NO_PARENT != ancestorA) && (FSM_NO_PARENT == common); ancestorA = parents[ancestorA])
+            {
+                for (uint8_t ancestorB = (uint8_t)b; FSM_NO_PARENT != ancestorB; ancestorB = parents[ancestorB])
+                {
+                    if (ancestorA == ancestorB)
+                    {
+                        common = ancestorA;
+                        break;
+                    }
+                }
+            }
+
+            lca[a * nrOfStates + b] = common;
+        }
+    }
+
+    if (0 == hierarchyAdded)
+    {
+        fsmDef->parents = parents;
+        fsmDef->lca = lca;
+    }
+    return hierarchyAdded;
+}
+
+/**
+ * @brief Set the states that deferred transitions may skip (see fsmCommit()):
+ *        if such a state is only passed through between two commits,
+ *        its entry and exit functions are not called.
+ *
+ * @param fsmDef - fsm definition
+ * @param coalesceMask - one bit per state (bit n of word w = state 32 * w + n),
+ *                       FSM_STATE_MASK_WORDS(nrOfStates) items, NULL for none
+ */
+void fsmDefSetCoalesceMask(FsmDef_t* fsmDef, const uint32_t* coalesceMask)
+{
+    fsmDef->coalesceMask = coalesceMask;
+}
+
+/**
+ * @brief Add input guards to the transitions of the fsm definition: a
+ *        transition is only taken if its input guard matches the input
+ *        word of the instance (see fsmSetInputs()), in addition to its
+ *        guard function. Used by fsmDispatch() if FSM_INPUT_GUARDS != 0.
+ *
+ * @param fsmDef - fsm definition, transitions must be set
+ * @param inputGuards - input guard of every transition (same order and number
+ *                      of items as the transitions), NULL for none
+ */
+void fsmDefSetInputGuards(FsmDef_t* fsmDef, const FsmInputGuard_t* inputGuards)
+{
+    fsmDef->inputGuards = inputGuards;
+}
+
+/**
+ * @brief Bind a fsm instance to its definition and set the init state
+ *        (state that is executed first). The definition is only referenced,
+ *        so it can be shared by several instances and must outlive them.
  *
  * @param fsmHandle - fsm instance
+ * @param fsmDef - fsm definition (state table) used by the instance
  * @param initState - state that should be started first
+ * @param context - user data passed to all state, entry and exit functions
+ *                  of this instance (may be NULL)
  * @return  0 - initState was set correctly
  *         -1 - initState exeed max number of states
  */
-int8_t fsmInit(FsmHandle_t* fsmHandle, const uint8_t initState)
+int8_t fsmInit(FsmHandle_t* fsmHandle, const FsmDef_t* fsmDef, const uint8_t initState, void* context)
 {
     int8_t stateAdded = -1;
 
-    for (uint8_t i = 0; i < FSM_MAX_NR_OF_STATES; i++)
-    {
-        fsmHandle->table[i].stateFunc = NULL;
-        fsmHandle->table[i].onEntryFunc = NULL;
-        fsmHandle->table[i].onExitFunc= NULL;
-    }
+    fsmHandle->def = fsmDef;
+    fsmHandle->context = context;
+#if (FSM_QUEUE != 0)
+    fsmHandle->queue = NULL;
+    fsmHandle->notifyFunc = NULL;
+    fsmHandle->notifyArg = NULL;
+#endif
+#if (FSM_TIMER != 0)
+    fsmHandle->timer = NULL;
+#endif
+#if (FSM_PROFILING != 0)
+    fsmHandle->profile = NULL;
+#endif
+#if (FSM_DEFERRED != 0)
+    fsmHandle->deferLog = NULL;
+#endif
+#if (FSM_INPUT_GUARDS != 0)
+    fsmHandle->inputs = 0;
+#endif
+#if (FSM_EXPORT != 0)
+    fsmHandle->exportSlot = NULL;
+#endif
+    fsmHandle->id = 0;
+    fsmHandle->maxSteps = 1;
 
-    if (initState < FSM_MAX_NR_OF_STATES)
+    if (initState < fsmDef->nrOfStates)
     {
         fsmHandle->currentState = initState;
         stateAdded = 0;
@@ -66,53 +350,536 @@ int8_t fsmInit(FsmHandle_t* fsmHandle, const uint8_t initState)
 }
 
 /**
- * @brief Register a state to the fsm.
+ * @brief Set the id of a fsm instance, used to identify the instance in
+ *        traces. Instances added to a scheduler get their scheduler id.
  *
  * @param fsmHandle - fsm instance
- * @param state - state index
- * @param stateFunc - function pointer that is called if state is executed
- * @param onEntryFunc - function pointer that is called when entering a new state
- * @param onExitFunc - function pointer that is called when leaving a state
- * @return  0 - state added successfully
- *         -1 - state could not be added
+ * @param id - instance id
  */
-int8_t fsmAdd(FsmHandle_t* fsmHandle, const uint8_t state, FsmStateFunc_t stateFunc, FsmOnEntryFunc_t onEntryFunc, FsmOnExitFunc_t onExitFunc)
+void fsmSetId(FsmHandle_t* fsmHandle, const uint16_t id)
 {
-    int8_t stateAdded = -1;
+    fsmHandle->id = id;
+}
+
+/**
+ * @brief Set the max number of state executions per fsmRun() call
+ *        (run to completion mode). fsmRun() keeps executing as long as
+ *        the state changes, until a state is kept or maxSteps is reached.
+ *
+ * @param fsmHandle - fsm instance
+ * @param maxSteps - max state executions per call, 1 = one state per call (default),
+ *                   0 is handled as 1
+ */
+void fsmSetMaxSteps(FsmHandle_t* fsmHandle, const uint8_t maxSteps)
+{
+    fsmHandle->maxSteps = (0 != maxSteps) ? maxSteps : 1;
+}
 
-    if ((state < FSM_MAX_NR_OF_STATES) && (stateFunc != NULL))
+#if (FSM_INPUT_GUARDS != 0)
+/**
+ * @brief Set the input word of an instance that is checked by the input
+ *        guards of the transitions on the next dispatch.
+ *
+ * @param fsmHandle - fsm instance
+ * @param inputs - input word, e.g. sampled digital inputs or status flags
+ */
+void fsmSetInputs(FsmHandle_t* fsmHandle, const uint32_t inputs)
+{
+    fsmHandle->inputs = inputs;
+}
+
+/**
+ * @brief Count trailing zeros of a non zero 32 bit value.
+ *
+ * @param value - value to check, must not be 0
+ * @return number of trailing zero bits (0 - 31)
+ */
+static inline uint8_t fsmCtz(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint8_t)__builtin_ctz(value);
+#else
+    uint8_t zeros = 0;
+
+    while (0 == (value & 1U))
     {
-        fsmHandle->table[state].stateFunc = stateFunc;
-        fsmHandle->table[state].onEntryFunc = onEntryFunc;
-        fsmHandle->table[state].onExitFunc = onExitFunc;
-        stateAdded = 0;
+        value >>= 1;
+        zeros++;
     }
-    return stateAdded;
+    return zeros;
+#endif
+}
+#endif
+
+/**
+ * @brief Check if a state is in range and registered
+ *        (has a function or transitions).
+ *
+ * @param fsmDef - fsm definition
+ * @param state - state to check
+ * @return 1 - state is valid
+ *         0 - state is out of range or not registered
+ */
+uint8_t fsmStateIsValid(const FsmDef_t* fsmDef, const uint8_t state)
+{
+    uint8_t stateValid = 0;
+
+    if (state < fsmDef->nrOfStates)
+    {
+        const FsmStateDef_t* stateDef = &fsmDef->table[state];
+
+        if ((NULL != stateDef->stateFunc) || (NULL != stateDef->onEntryFunc) || (NULL != stateDef->onExitFunc) ||
+            ((NULL != fsmDef->transitions) && (fsmDef->transitionIndex[state] != fsmDef->transitionIndex[state + 1])))
+        {
+            stateValid = 1;
+        }
+    }
+    return stateValid;
+}
+
+#if (FSM_CHECK_NEXT_STATE != 0)
+/**
+ * @brief Get the state to go to instead of an invalid next state.
+ *
+ * @param fsmHandle - fsm instance
+ * @param invalidState - invalid next state returned by the state function
+ * @return state from the error function if valid, else current state
+ */
+static uint8_t fsmInvalidState(FsmHandle_t* fsmHandle, const uint8_t invalidState)
+{
+    uint8_t state = fsmHandle->currentState;
+
+    if (NULL != fsmHandle->def->errorFunc)
+    {
+        uint8_t errorState = fsmHandle->def->errorFunc(fsmHandle->context, fsmHandle->currentState, invalidState);
+
+        if (0 != fsmStateIsValid(fsmHandle->def, errorState))
+        {
+            state = errorState;
+        }
+    }
+    return state;
+}
+#endif
+
+/**
+ * @brief Find the first transition of a state that matches the
+ *        event and whose input guard and guard function pass.
+ *
+ * @param fsmHandle - fsm instance
+ * @param state - state whose transitions are checked
+ * @param event - dispatched event
+ * @return matching transition or NULL
+ */
+static const FsmTransition_t* fsmFindTransition(FsmHandle_t* fsmHandle, const uint8_t state, const FsmEvent_t event)
+{
+    const FsmDef_t* fsmDef = fsmHandle->def;
+    const FsmTransition_t* transition = NULL;
+
+    if (NULL != fsmDef->transitions)
+    {
+        uint16_t end = fsmDef->transitionIndex[state + 1];
+
+#if (FSM_INPUT_GUARDS != 0)
+        if (NULL != fsmDef->inputGuards)
+        {
+            /* blocks of 32 transitions: event and input guard of all of them into one bitmask without branches */
+            for (uint16_t base = fsmDef->transitionIndex[state]; (base < end) && (NULL == transition); base += 32U)
+            {
+                uint16_t count = ((uint16_t)(end - base) < 32U) ? (uint16_t)(end - base) : 32U;
+                uint32_t matches = 0;
+
+                for (uint16_t i = 0; i < count; i++)
+                {
+                    const FsmInputGuard_t* inputGuard = &fsmDef->inputGuards[base + i];
+
+                    matches |= (uint32_t)((fsmDef->transitions[base + i].event == event) &
+                                          ((fsmHandle->inputs & inputGuard->mask) == inputGuard->value)) << i;
+                }
+
+                while ((0 != matches) && (NULL == transition))
+                {
+                    const FsmTransition_t* candidate = &fsmDef->transitions[base + fsmCtz(matches)];
+
+                    if ((NULL == candidate->guardFunc) || (0 != candidate->guardFunc(fsmHandle->context, event)))
+                    {
+                        transition = candidate;
+                    }
+                    matches &= matches - 1U; /* next match in table order */
+                }
+            }
+        }
+        else
+#endif
+        for (uint16_t i = fsmDef->transitionIndex[state]; i < end; i++)
+        {
+            const FsmTransition_t* candidate = &fsmDef->transitions[i];
+
+            if ((candidate->event == event) &&
+                ((NULL == candidate->guardFunc) || (0 != candidate->guardFunc(fsmHandle->context, event))))
+            {
+                transition = candidate;
+                break;
+            }
+        }
+    }
+    return transition;
 }
 
 /**
- * @brief FSM Core - execute the fsm.
+ * @brief Find the next state for an event. The current state handles the
+ *        event first (transition table, then state function). If it returns
+ *        FSM_UNHANDLED, the event bubbles up to the parent states.
  *
  * @param fsmHandle - fsm instance
+ * @param event - dispatched event
+ * @param transition - [out] transition that handled the event or NULL
+ * @return next state, current state if the event is not handled or the
+ *         handling state returned itself
  */
-void fsmRun(FsmHandle_t* fsmHandle)
+static uint8_t fsmFindNextState(FsmHandle_t* fsmHandle, const FsmEvent_t event, const FsmTransition_t** transition)
 {
-    if (NULL != fsmHandle->table[fsmHandle->currentState].stateFunc)
+    const FsmDef_t* fsmDef = fsmHandle->def;
+    uint8_t state = fsmHandle->currentState;
+    uint8_t stateNext = FSM_UNHANDLED;
+
+    *transition = NULL;
+
+    while (FSM_UNHANDLED == stateNext)
     {
-        uint8_t stateNext = fsmHandle->table[fsmHandle->currentState].stateFunc();
+        *transition = fsmFindTransition(fsmHandle, state, event);
 
-        if (fsmHandle->currentState != stateNext)
+        if (NULL != *transition)
         {
-            if (NULL != fsmHandle->table[fsmHandle->currentState].onExitFunc)
+            stateNext = (*transition)->nextState;
+        }
+        else if (NULL != fsmDef->table[state].stateFunc)
+        {
+            stateNext = fsmDef->table[state].stateFunc(fsmHandle->context, event);
+        }
+
+        if (state == stateNext)
+        {
+            /* handled by a (parent) state without transition */
+            stateNext = fsmHandle->currentState;
+        }
+        else if (FSM_UNHANDLED == stateNext)
+        {
+            state = (NULL != fsmDef->parents) ? fsmDef->parents[state] : FSM_NO_PARENT;
+
+            if (FSM_NO_PARENT == state)
             {
-                fsmHandle->table[fsmHandle->currentState].onExitFunc();
+                stateNext = fsmHandle->currentState; /* not handled by any state */
             }
-            if (NULL != fsmHandle->table[stateNext].onEntryFunc)
+        }
+    }
+    return stateNext;
+}
+
+/**
+ * @brief Get the least common ancestor of two states.
+ *
+ * @param fsmDef - fsm definition
+ * @param state - first state
+ * @param stateNext - second state
+ * @return common ancestor, FSM_NO_PARENT for a flat fsm or no common ancestor
+ */
+static inline uint8_t fsmGetAncestor(const FsmDef_t* fsmDef, const uint8_t state, const uint8_t stateNext)
+{
+    uint8_t ancestor = FSM_NO_PARENT;
+
+    if (NULL != fsmDef->lca)
+    {
+        ancestor = fsmDef->lca[(uint16_t)state * fsmDef->nrOfStates + stateNext];
+    }
+    return ancestor;
+}
+
+/**
+ * @brief Leave a state: call the exit functions from the state up to
+ *        (not including) the common ancestor with the next state.
+ *
+ * @param fsmHandle - fsm instance
+ * @param stateLeft - state that is left
+ * @param ancestor - common ancestor of the left and the next state
+ */
+static void fsmExitStates(FsmHandle_t* fsmHandle, const uint8_t stateLeft, const uint8_t ancestor)
+{
+    const FsmDef_t* fsmDef = fsmHandle->def;
+    uint8_t state = stateLeft;
+
+    while (state != ancestor)
+    {
+        if (NULL != fsmDef->table[state].onExitFunc)
+        {
+            fsmDef->table[state].onExitFunc(fsmHandle->context);
+        }
+        state = (NULL != fsmDef->parents) ? fsmDef->parents[state] : FSM_NO_PARENT;
+    }
+}
+
+/**
+ * @brief Enter the next state: call the entry functions from below the
+ *        common ancestor down to the next state.
+ *
+ * @param fsmHandle - fsm instance
+ * @param ancestor - common ancestor of the left and the next state
+ * @param stateNext - state that is entered
+ */
+static void fsmEnterStates(FsmHandle_t* fsmHandle, const uint8_t ancestor, const uint8_t stateNext)
+{
+    const FsmDef_t* fsmDef = fsmHandle->def;
+    uint8_t path[FSM_MAX_DEPTH];
+    uint8_t depth = 0;
+    uint8_t state = stateNext;
+
+    if (NULL == fsmDef->parents)
+    {
+        path[0] = stateNext; /* flat fsm */
+        depth = 1;
+    }
+    else
+    {
+        /* fsmDefSetHierarchy() guarantees the path is not deeper than FSM_MAX_DEPTH */
+        while ((state != ancestor) && (depth < FSM_MAX_DEPTH))
+        {
+            path[depth] = state;
+            depth++;
+            state = fsmDef->parents[state];
+        }
+    }
+
+    while (depth > 0)
+    {
+        depth--;
+        if (NULL != fsmDef->table[path[depth]].onEntryFunc)
+        {
+            fsmDef->table[path[depth]].onEntryFunc(fsmHandle->context);
+        }
+    }
+}
+
+#if (FSM_DEFERRED != 0)
+/**
+ * @brief Attach a defer log to a fsm instance: entry and exit functions
+ *        of transitions are called by fsmCommit() instead of fsmDispatch().
+ *
+ * @param fsmHandle - fsm instance
+ * @param deferLog - defer log of the instance, NULL to call entry and exit
+ *                   functions immediately again (pending ones are committed)
+ * @param states - state array of the log (size items)
+ * @param size - max number of recorded states (2 - 255), the log is
+ *               committed automatically if it is full
+ * @return  0 - defer log attached
+ *         -1 - invalid state array or size
+ */
+int8_t fsmAttachDeferLog(FsmHandle_t* fsmHandle, FsmDeferLog_t* deferLog, uint8_t* states, const uint8_t size)
+{
+    int8_t logAttached = -1;
+
+    if (NULL != fsmHandle->deferLog)
+    {
+        fsmCommit(fsmHandle);
+    }
+
+    if (NULL == deferLog)
+    {
+        fsmHandle->deferLog = NULL;
+        logAttached = 0;
+    }
+    else if ((NULL != states) && (size >= 2))
+    {
+        deferLog->states = states;
+        deferLog->size = size;
+        deferLog->count = 0;
+        fsmHandle->deferLog = deferLog;
+        logAttached = 0;
+    }
+    return logAttached;
+}
+
+/**
+ * @brief Call the deferred entry and exit functions of all transitions
+ *        since the last commit, in the order of the transitions.
+ *
+ * @param fsmHandle - fsm instance
+ */
+void fsmCommit(FsmHandle_t* fsmHandle)
+{
+    FsmDeferLog_t* deferLog = fsmHandle->deferLog;
+
+    if (NULL != deferLog)
+    {
+        for (uint8_t i = 1; i < deferLog->count; i++)
+        {
+            uint8_t ancestor = fsmGetAncestor(fsmHandle->def, deferLog->states[i - 1], deferLog->states[i]);
+
+            fsmExitStates(fsmHandle, deferLog->states[i - 1], ancestor);
+            fsmEnterStates(fsmHandle, ancestor, deferLog->states[i]);
+        }
+        deferLog->count = 0;
+    }
+}
+
+/**
+ * @brief Record a transition in the defer log. A coalescible state that
+ *        was only passed through is removed, a transition back to the
+ *        previous state cancels out.
+ *
+ * @param fsmHandle - fsm instance with defer log
+ * @param state - state that is left
+ * @param stateNext - state that is entered
+ */
+static void fsmDeferRecord(FsmHandle_t* fsmHandle, const uint8_t state, const uint8_t stateNext)
+{
+    FsmDeferLog_t* deferLog = fsmHandle->deferLog;
+    const uint32_t* coalesceMask = fsmHandle->def->coalesceMask;
+
+    if (0 == deferLog->count)
+    {
+        deferLog->states[0] = state;
+        deferLog->count = 1;
+    }
+
+    if ((deferLog->count > 1) && (NULL != coalesceMask) && (0 != (coalesceMask[state >> 5] & (1UL << (state & 31U)))))
+    {
+        deferLog->count--; /* state was only passed through */
+    }
+
+    if (deferLog->states[deferLog->count - 1] != stateNext)
+    {
+        if (deferLog->count == deferLog->size)
+        {
+            fsmCommit(fsmHandle);
+            deferLog->states[0] = state;
+            deferLog->count = 1;
+        }
+        deferLog->states[deferLog->count] = stateNext;
+        deferLog->count++;
+    }
+}
+#endif
+
+/**
+ * @brief FSM Core - execute the current state once with the given event.
+ *
+ * @param fsmHandle - fsm instance
+ * @param event - event that is passed to the state function
+ */
+void fsmDispatch(FsmHandle_t* fsmHandle, const FsmEvent_t event)
+{
+    const uint8_t state = fsmHandle->currentState;
+    uint8_t eventValid = 1;
+
+#if (FSM_TIMER != 0)
+    if ((FSM_EVENT_TIMEOUT == event) && (NULL != fsmHandle->timer))
+    {
+        /* a queued timeout is stale if the state was left (timer restarted) meanwhile */
+        eventValid = fsmHandle->timer->expired;
+        fsmHandle->timer->expired = 0;
+    }
+#endif
+
+    if (0 != eventValid)
+    {
+#if (FSM_PROFILING != 0)
+        uint32_t profileStart = FSM_PROFILE_CYCLES();
+#endif
+        const FsmTransition_t* transition;
+        uint8_t stateNext = fsmFindNextState(fsmHandle, event, &transition);
+        uint8_t ancestor = FSM_NO_PARENT;
+        uint8_t deferred = 0;
+
+#if (FSM_CHECK_NEXT_STATE != 0)
+        if ((state != stateNext) && FSM_UNLIKELY(0 == fsmStateIsValid(fsmHandle->def, stateNext)))
+        {
+            stateNext = fsmInvalidState(fsmHandle, stateNext);
+        }
+#endif
+
+#if (FSM_PROFILING != 0)
+        fsmProfileState(fsmHandle->profile, fsmHandle, state, profileStart);
+        profileStart = FSM_PROFILE_CYCLES();
+#endif
+
+        if (state != stateNext)
+        {
+#if (FSM_DEFERRED != 0)
+            if (NULL != fsmHandle->deferLog)
+            {
+                fsmDeferRecord(fsmHandle, state, stateNext);
+                deferred = 1;
+            }
+            else
+#endif
             {
-                fsmHandle->table[stateNext].onEntryFunc();
+                ancestor = fsmGetAncestor(fsmHandle->def, state, stateNext);
+                fsmExitStates(fsmHandle, state, ancestor);
             }
+        }
+
+        if ((NULL != transition) && (NULL != transition->actionFunc))
+        {
+            transition->actionFunc(fsmHandle->context, event);
+        }
+
+        if ((state != stateNext) && (0 == deferred))
+        {
+            fsmEnterStates(fsmHandle, ancestor, stateNext);
+        }
+
+#if (FSM_PROFILING != 0)
+        if ((state != stateNext) || (NULL != transition))
+        {
+            fsmProfileTransition(fsmHandle->profile, state, stateNext, profileStart);
+        }
+#endif
+
+        if (state != stateNext)
+        {
             fsmHandle->currentState = stateNext;
+
+#if (FSM_TRACE != 0)
+            fsmTraceTransition(fsmHandle->id, state, stateNext);
+#endif
+#if (FSM_EXPORT != 0)
+            fsmExportWrite(fsmHandle->exportSlot, fsmHandle->id, stateNext);
+#endif
+#if (FSM_TIMER != 0)
+            if (NULL != fsmHandle->timer)
+            {
+                uint32_t timeout = fsmHandle->def->table[stateNext].timeout;
+
+                fsmTimerStop(fsmHandle->timer);
+                if (0 != timeout)
+                {
+                    fsmTimerStart(fsmHandle->timer, timeout);
+                }
+            }
+#endif
         }
     }
 }
 
+/**
+ * @brief Execute the fsm in polling mode (dispatch FSM_EVENT_TICK).
+ *        The current state is executed once, in run to completion mode
+ *        again while the state changes (up to maxSteps times).
+ *
+ * @param fsmHandle - fsm instance
+ * @return number of executed states (1 - maxSteps)
+ */
+uint8_t fsmRun(FsmHandle_t* fsmHandle)
+{
+    uint8_t steps = 0;
+    uint8_t state;
+
+    do
+    {
+        state = fsmHandle->currentState;
+        fsmDispatch(fsmHandle, FSM_EVENT_TICK);
+        steps++;
+    } while ((state != fsmHandle->currentState) && (steps < fsmHandle->maxSteps));
+
+    return steps;
+}
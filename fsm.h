@@ -30,15 +30,87 @@
  ********************************************************************************
  *
  * The module can be used to create simple table based FSM instances.
- * Every FSM can hold up to FSM_MAX_NR_OF_STATES (1 - 255) with optional
- * entry and exit functions.
+ * Every FSM can hold up to 255 states with optional entry and exit functions.
  *
- * No dynamic memory allocation is used. Be aware that the
- * fsm table always holds FSM_MAX_NR_OF_STATES items,
- * even if there are less states used for some FSM instances.
+ * The state table is kept in a definition (FsmDef_t) that is separated from
+ * the runtime instance (FsmHandle_t). A definition can be declared const so
+ * it is placed in flash / .rodata and shared by any number of instances,
+ * each instance only holds its current state and a pointer to the definition.
+ *
+ * Every instance carries a user context pointer (set with fsmInit()) that is
+ * passed to all state, entry and exit functions of this instance. This way
+ * several instances of the same machine can work on their own data
+ * (e.g. one instance per connection) without duplicating the state functions.
+ * The context may be NULL if the state functions need no instance data.
+ *
+ * No dynamic memory allocation is used. The state table is an array
+ * provided by the user, so every definition is sized to the number of
+ * states it actually uses (see FSM_DEF_INIT()).
  *
  * Every time fsmRun(&fsmHandle) is called, the FSM is executed once.
  * On first call, initial state will be executed without entry function.
+ * In run to completion mode (see fsmSetMaxSteps()) fsmRun() keeps executing
+ * while the state changes, so a chain of transient states
+ * (e.g. INIT -> CONFIGURE -> READY) is passed in one call instead of one
+ * main loop iteration per state. The number of state executions per call
+ * is limited to protect real time deadlines, fsmRun() returns the number
+ * of executed steps.
+ *
+ * State functions receive the event that caused their execution.
+ * fsmRun() is the polling mode and passes FSM_EVENT_TICK. In event driven
+ * mode the application calls fsmDispatch(&fsmHandle, event) only when
+ * something happened, so an idle FSM costs no cycles at all and the
+ * MCU can sleep between events. Both modes can be mixed on one instance.
+ * Events from interrupts or other threads are posted to an event queue
+ * attached to the instance (FSM_QUEUE = 1, see fsmQueue.h).
+ *
+ * Every state can have a timeout in timer ticks (0 = no timeout). If a
+ * timer is attached to the instance (FSM_TIMER = 1, see fsmTimer.h), it is armed
+ * automatically on entry of the state and the state function receives
+ * FSM_EVENT_TIMEOUT if the state was not left in time.
+ *
+ * Instead of (or in addition to) state functions, transitions can be given
+ * as a constant table of (state, event, guard, action, next state) entries
+ * sorted by state (see fsmDefSetTransitions()). On dispatch the transitions
+ * of the current state are checked first, in table order. The first entry
+ * with a matching event and a passing guard is taken: exit function,
+ * action, entry function. If no entry matches, the state function is
+ * called (if there is one). States that only route events therefore need
+ * no state function and no indirect call to find the next state.
+ *
+ * Guards that only test input bits can be given as (mask, value) pairs on
+ * the input word of the instance instead of guard functions (see
+ * FSM_INPUT_GUARDS, fsmDefSetInputGuards(), fsmSetInputs()). All transitions
+ * of the current state are then tested without branches into a bitmask and
+ * the first match is found with count trailing zeros.
+ *
+ * States can be nested (statechart style, see fsmDefSetHierarchy()). A state
+ * function that does not handle an event returns FSM_UNHANDLED and the event
+ * bubbles up to the parent states, so common handling (e.g. disconnect) is
+ * written once in the parent. A state (or parent) that returns itself keeps
+ * the current state. On a transition the exit functions are called from the
+ * current state up to the least common ancestor, the entry functions from
+ * below the ancestor down to the next state. The ancestors are precomputed
+ * when the hierarchy is set, transitions don't search the tree.
+ *
+ * With FSM_DEFERRED = 1 an instance with a defer log (see fsmAttachDeferLog())
+ * calls no entry / exit functions on transitions, the passed states are
+ * recorded and their entry / exit functions are called at the next commit
+ * point (fsmCommit(), e.g. once per scheduler tick). States marked in the
+ * coalesce mask of the definition are skipped if they were only passed
+ * through, so A -> B -> A with coalescible B calls nothing at all.
+ * Actions, timeouts and traces are not deferred.
+ *
+ * If a state function returns a state that is out of range or was never
+ * registered (no functions and no transitions), the error function of the
+ * definition is called and decides which state is used instead. Without
+ * error function the fsm stays in the current state. The check is only
+ * executed on transitions (not if the state is kept) and is a predicted
+ * not taken branch, on Cortex-M3/M4 the range check costs about 2 cycles
+ * (CMP + not taken branch) and the registration check about 10 cycles
+ * (pointer loads of the next state, which are needed for the entry
+ * function anyway). Fully verified builds can remove the check with
+ * FSM_CHECK_NEXT_STATE = 0.
  *
  * Example usage:
  *
@@ -49,7 +121,7 @@
  *     FSM_STATE_ACTIVE,
  * } FsmState_t;
  *
- * static uint8_t StateInit(void)
+ * static uint8_t StateInit(void* context, const FsmEvent_t event)
  * {
  *     uint8_t nextState = FSM_STATE_INACTIVE;
  *
@@ -59,17 +131,17 @@
  *     return nextState;
  * }
  *
- * static void OnEntryInactive(void)
+ * static void OnEntryInactive(void* context)
  * {
  *     gpioSet(LED1_PORT, LED1_PIN, GPIO_PIN_RESET);
  *     printf("Enter state INACTIVE\r\n");
  * }
  *
- * static uint8_t StateInactive(void)
+ * static uint8_t StateInactive(void* context, const FsmEvent_t event)
  * {
  *     uint8_t nextState = FSM_STATE_INACTIVE;
  *
- *     if (GPIO_PIN_SET = gpioRead(BUTTON1_PORT, BUTTON1_PIN))
+ *     if (GPIO_PIN_SET == gpioRead(BUTTON1_PORT, BUTTON1_PIN))
  *     {
  *         nextState = FSM_STATE_ACTIVE;
  *     }
@@ -77,17 +149,17 @@
  *     return nextState;
  * }
  *
- * static void OnEntryActive(void)
+ * static void OnEntryActive(void* context)
  * {
  *     gpioSet(LED1_PORT, LED1_PIN, GPIO_PIN_SET);
  *     printf("Enter state ACTIVE\r\n");
  * }
  *
- * static uint8_t StateActive(void)
+ * static uint8_t StateActive(void* context, const FsmEvent_t event)
  * {
  *     uint8_t nextState = FSM_STATE_ACTIVE;
  *
- *     if (GPIO_PIN_RESET = gpioRead(BUTTON1_PORT, BUTTON1_PIN))
+ *     if (GPIO_PIN_RESET == gpioRead(BUTTON1_PORT, BUTTON1_PIN))
  *     {
  *         nextState = FSM_STATE_INACTIVE;
  *     }
@@ -95,20 +167,25 @@
  *     return nextState;
  * }
  *
- * static void OnEntryActive(void)
+ * static void OnExitActive(void* context)
  * {
  *     printf("Exit state ACTIVE\r\n");
  * }
  *
+ * static const FsmStateDef_t fsmTable[] =
+ * {
+ *     [FSM_STATE_INIT]     = { StateInit,     NULL,            NULL },
+ *     [FSM_STATE_INACTIVE] = { StateInactive, OnEntryInactive, NULL },
+ *     [FSM_STATE_ACTIVE]   = { StateActive,   OnEntryActive,   OnExitActive },
+ * };
+ *
+ * static const FsmDef_t fsmDef = FSM_DEF_INIT(fsmTable);
+ *
  * void main(void)
  * {
  *     FsmHandle_t fsmHandle;
  *
- *     fsmInit(&fsmHandle, FSM_STATE_INIT);
- *
- *     fsmAdd(&fsmHandle, FSM_STATE_INIT,     StateInit,     onEntryOne,      NULL);
- *     fsmAdd(&fsmHandle, FSM_STATE_INACTIVE, StateInactive, OnEntryInactive, NULL);
- *     fsmAdd(&fsmHandle, FSM_STATE_ACTIVE,   StateActive,   OnEntryActive,   OnExitActive);
+ *     fsmInit(&fsmHandle, &fsmDef, FSM_STATE_INIT, NULL);
  *
  *     while (1)
  *     {
@@ -116,29 +193,327 @@
  *     }
  * }
  *
+ * The instance can be initialized statically as well, then it is ready
+ * without any call at boot (see FSM_HANDLE_INIT(), FSM_DEFINE()):
+ *
+ *     static FsmHandle_t fsmHandle = FSM_HANDLE_INIT(&fsmDef, FSM_STATE_INIT, NULL);
+ *
+ * If the state table has to be set up at runtime, a non-const definition
+ * can be filled with fsmDefInit() and fsmAdd() before it is passed to fsmInit():
+ *
+ *     static FsmStateDef_t fsmTable[3];
+ *     static FsmDef_t fsmDef;
+ *
+ *     fsmDefInit(&fsmDef, fsmTable, 3);
+ *     fsmAdd(&fsmDef, FSM_STATE_INIT,     StateInit,     NULL,            NULL,         0);
+ *     fsmAdd(&fsmDef, FSM_STATE_INACTIVE, StateInactive, OnEntryInactive, NULL,         0);
+ *     fsmAdd(&fsmDef, FSM_STATE_ACTIVE,   StateActive,   OnEntryActive,   OnExitActive, 0);
+ *
+ * Running several instances of one definition, each with its own data:
+ *
+ *     static Connection_t connections[NR_OF_CONNECTIONS];
+ *     static FsmHandle_t connectionFsm[NR_OF_CONNECTIONS];
+ *
+ *     for (uint8_t i = 0; i < NR_OF_CONNECTIONS; i++)
+ *     {
+ *         fsmInit(&connectionFsm[i], &connectionFsmDef, CONN_STATE_IDLE, &connections[i]);
+ *     }
+ *
+ * Event driven usage, state functions only run if an event is dispatched:
+ *
+ *     enum
+ *     {
+ *         EVENT_BUTTON_PRESSED = FSM_EVENT_USER,
+ *         EVENT_BUTTON_RELEASED,
+ *     };
+ *
+ *     static uint8_t StateInactive(void* context, const FsmEvent_t event)
+ *     {
+ *         uint8_t nextState = FSM_STATE_INACTIVE;
+ *
+ *         if (EVENT_BUTTON_PRESSED == event)
+ *         {
+ *             nextState = FSM_STATE_ACTIVE;
+ *         }
+ *
+ *         return nextState;
+ *     }
+ *
+ *     while (1)
+ *     {
+ *         if (buttonChanged())
+ *         {
+ *             fsmDispatch(&fsmHandle, buttonPressed() ? EVENT_BUTTON_PRESSED : EVENT_BUTTON_RELEASED);
+ *         }
+ *         sleepUntilInterrupt();
+ *     }
+ *
  ********************************************************************************/
 
+#ifndef FSM_H
+#define FSM_H
+
 #include "stdint.h"
 
-#define FSM_MAX_NR_OF_STATES  (uint8_t)10U
+/* Atomic and aligned members of the module headers (fsmQueue.h, fsmSched.h, ...),
+ * C11 _Atomic / _Alignas in C and std::atomic / alignas if included from C++. */
+#ifdef __cplusplus
+extern "C++"
+{
+#include <atomic>
+}
+#define FSM_ATOMIC(type)    std::atomic<type>
+#define FSM_ALIGNAS(align)  alignas(align)
+#else
+#define FSM_ATOMIC(type)    _Atomic type
+#define FSM_ALIGNAS(align)  _Alignas(align)
+#endif
+
+/* Check next states returned by state functions (out of range or unregistered)
+ * and route invalid ones to the error function of the definition.
+ * Can be set to 0 for fully verified builds to remove the check. */
+#ifndef FSM_CHECK_NEXT_STATE
+#define FSM_CHECK_NEXT_STATE  1
+#endif
+
+/* Event queue and notify hook per instance (see fsmQueue.h). */
+#ifndef FSM_QUEUE
+#define FSM_QUEUE  0
+#endif
+
+/* State timeouts driven by a timer per instance (see fsmTimer.h). */
+#ifndef FSM_TIMER
+#define FSM_TIMER  0
+#endif
+
+/* Record per state and per transition cycle statistics (see fsmProfile.h). */
+#ifndef FSM_PROFILING
+#define FSM_PROFILING  0
+#endif
+
+/* Write every transition to the trace sink (see fsmTrace.h). */
+#ifndef FSM_TRACE
+#define FSM_TRACE  0
+#endif
+
+/* Defer entry / exit functions of instances with a defer log to fsmCommit() (see fsmAttachDeferLog()). */
+#ifndef FSM_DEFERRED
+#define FSM_DEFERRED  0
+#endif
+
+/* Input word per instance for (mask, value) guards of transitions (see fsmDefSetInputGuards()). */
+#ifndef FSM_INPUT_GUARDS
+#define FSM_INPUT_GUARDS  0
+#endif
+
+/* Publish the state of instances with an export slot to shared memory (see fsmExport.h). */
+#ifndef FSM_EXPORT
+#define FSM_EXPORT  0
+#endif
+
+/* Max nesting depth of hierarchical states. */
+#ifndef FSM_MAX_DEPTH
+#define FSM_MAX_DEPTH  8U
+#endif
+
+typedef uint8_t FsmEvent_t;
 
-typedef uint8_t FsmStateFunc_t(void);
-typedef void FsmOnEntryFunc_t(void);
-typedef void FsmOnExitFunc_t(void);
+/* Returned by a state function that does not handle an event, the event
+ * is passed on to the parent state. */
+#define FSM_UNHANDLED  (uint8_t)0xFFU
+
+/* Parent of a top level state. */
+#define FSM_NO_PARENT  (uint8_t)0xFFU
+
+/* Events 0 - (FSM_EVENT_USER - 1) are reserved for the fsm module. */
+#define FSM_EVENT_TICK     (FsmEvent_t)0U  /* polling call, used by fsmRun() */
+#define FSM_EVENT_TIMEOUT  (FsmEvent_t)1U  /* state timeout expired */
+#define FSM_EVENT_USER     (FsmEvent_t)16U /* first application defined event */
+
+typedef struct FsmQueue FsmQueue_t; /* see fsmQueue.h */
+typedef struct FsmTimer FsmTimer_t; /* see fsmTimer.h */
+typedef struct FsmProfile FsmProfile_t; /* see fsmProfile.h */
+typedef struct FsmExportSlot FsmExportSlot_t; /* see fsmExport.h */
+
+/* Called after an event was posted to an instance, e.g. to mark it ready in a scheduler. */
+typedef void FsmNotifyFunc_t(void* notifyArg, const uint16_t id);
+
+typedef uint8_t FsmStateFunc_t(void* context, const FsmEvent_t event);
+typedef void FsmOnEntryFunc_t(void* context);
+typedef void FsmOnExitFunc_t(void* context);
+typedef uint8_t FsmGuardFunc_t(void* context, const FsmEvent_t event);
+typedef void FsmActionFunc_t(void* context, const FsmEvent_t event);
+typedef uint8_t FsmErrorFunc_t(void* context, const uint8_t state, const uint8_t invalidState);
 
 typedef struct
 {
     FsmStateFunc_t* stateFunc;
     FsmOnEntryFunc_t* onEntryFunc;
     FsmOnExitFunc_t* onExitFunc;
+    uint32_t timeout;
+#if (FSM_PROFILING != 0)
+    uint32_t budget; /* max cycles of the state function, 0 = none (see fsmProfile.h) */
+#endif
 } FsmStateDef_t;
 
+/* Budget of a state table entry, last field after the timeout. Without FSM_PROFILING the entry has no budget. */
+#if (FSM_PROFILING != 0)
+#define FSM_STATE_BUDGET(cycles)  (cycles)
+#else
+#define FSM_STATE_BUDGET(cycles)
+#endif
+
+typedef struct
+{
+    uint8_t state;
+    FsmEvent_t event;
+    FsmGuardFunc_t* guardFunc;   /* transition is taken if NULL or returns != 0 */
+    FsmActionFunc_t* actionFunc; /* called between exit and entry function, may be NULL */
+    uint8_t nextState;
+} FsmTransition_t;
+
+/* Guard on the input word of an instance (see fsmSetInputs()), the transition
+ * is taken if (inputs & mask) == value. { 0, 0 } always passes. */
 typedef struct
 {
+    uint32_t mask;
+    uint32_t value;
+} FsmInputGuard_t;
+
+/* Number of 32 bit words of a bitmask with one bit per state. */
+#define FSM_STATE_MASK_WORDS(nrOfStates)  (((uint16_t)(nrOfStates) + 31U) / 32U)
+
+typedef struct
+{
+    const FsmStateDef_t* table;
+    const FsmTransition_t* transitions;
+    const uint16_t* transitionIndex; /* transitions of state s: transitionIndex[s] - transitionIndex[s + 1] - 1 */
+    uint8_t nrOfStates;
+    FsmErrorFunc_t* errorFunc; /* returns the state to go to instead of an invalid next state, may be NULL */
+    const uint8_t* parents;    /* parent of every state, NULL for a flat fsm */
+    const uint8_t* lca;        /* least common ancestor of states a and b: lca[a * nrOfStates + b] */
+    const uint32_t* coalesceMask;       /* bit set if a deferred transition may skip the state, NULL for none */
+    const FsmInputGuard_t* inputGuards; /* input guard of every transition, NULL for none */
+} FsmDef_t;
+
+/* Number of states of a state table array, the table must be an array (not a pointer). */
+#define FSM_NR_OF_STATES(table)  (uint8_t)(sizeof(table) / sizeof((table)[0]))
+
+/* Static initializer for a definition that uses the whole state table array. */
+#define FSM_DEF_INIT(table)  { (table), NULL, NULL, FSM_NR_OF_STATES(table), NULL, NULL, NULL, NULL, NULL }
+
+/* Static initializer for a definition with a transition table and a precomputed
+ * transition index (nrOfStates + 1 items, e.g. generated offline). */
+#define FSM_DEF_INIT_TRANSITIONS(table, transitions, transitionIndex)  { (table), (transitions), (transitionIndex), FSM_NR_OF_STATES(table), NULL, NULL, NULL, NULL, NULL }
+
+/* States passed since the last fsmCommit(), states[0] is the state whose
+ * entry function was called last. */
+typedef struct
+{
+    uint8_t* states;
+    uint8_t size;
+    uint8_t count;
+} FsmDeferLog_t;
+
+typedef struct
+{
+    const FsmDef_t* def;
+    void* context;
+#if (FSM_QUEUE != 0)
+    FsmQueue_t* queue;
+    FsmNotifyFunc_t* notifyFunc;
+    void* notifyArg;
+#endif
+#if (FSM_TIMER != 0)
+    FsmTimer_t* timer;
+#endif
+#if (FSM_PROFILING != 0)
+    FsmProfile_t* profile;
+#endif
+#if (FSM_DEFERRED != 0)
+    FsmDeferLog_t* deferLog;
+#endif
+#if (FSM_INPUT_GUARDS != 0)
+    uint32_t inputs; /* input word checked by the input guards of the transitions */
+#endif
+#if (FSM_EXPORT != 0)
+    FsmExportSlot_t* exportSlot;
+#endif
+    uint16_t id;
     uint8_t currentState;
-    FsmStateDef_t table[FSM_MAX_NR_OF_STATES];
+    uint8_t maxSteps; /* max state executions per fsmRun() call, 1 = one state per call */
 } FsmHandle_t;
 
-int8_t fsmInit(FsmHandle_t* fsmHandle, const uint8_t initState);
-int8_t fsmAdd(FsmHandle_t* fsmHandle, const uint8_t state, FsmStateFunc_t stateFunc, FsmOnEntryFunc_t onEntryFunc, FsmOnExitFunc_t onExitFunc);
-void fsmRun(FsmHandle_t* fsmHandle);
+/* Optional members of FsmHandle_t, used by FSM_HANDLE_INIT_ID(). */
+#if (FSM_QUEUE != 0)
+#define FSM_HANDLE_INIT_QUEUE     NULL, NULL, NULL,
+#else
+#define FSM_HANDLE_INIT_QUEUE
+#endif
+#if (FSM_TIMER != 0)
+#define FSM_HANDLE_INIT_TIMER     NULL,
+#else
+#define FSM_HANDLE_INIT_TIMER
+#endif
+#if (FSM_PROFILING != 0)
+#define FSM_HANDLE_INIT_PROFILE   NULL,
+#else
+#define FSM_HANDLE_INIT_PROFILE
+#endif
+#if (FSM_DEFERRED != 0)
+#define FSM_HANDLE_INIT_DEFERRED  NULL,
+#else
+#define FSM_HANDLE_INIT_DEFERRED
+#endif
+#if (FSM_INPUT_GUARDS != 0)
+#define FSM_HANDLE_INIT_INPUTS    0U,
+#else
+#define FSM_HANDLE_INIT_INPUTS
+#endif
+#if (FSM_EXPORT != 0)
+#define FSM_HANDLE_INIT_EXPORT    NULL,
+#else
+#define FSM_HANDLE_INIT_EXPORT
+#endif
+
+/* Static initializer for an instance with an id, same as fsmInit() followed by
+ * fsmSetId() (no queue, timer or notify function, one state per fsmRun()).
+ * initState is not checked, it must be a state of the definition. */
+#define FSM_HANDLE_INIT_ID(fsmDef, initState, context, id)  { (fsmDef), (context), \
+                                                              FSM_HANDLE_INIT_QUEUE FSM_HANDLE_INIT_TIMER \
+                                                              FSM_HANDLE_INIT_PROFILE FSM_HANDLE_INIT_DEFERRED FSM_HANDLE_INIT_INPUTS FSM_HANDLE_INIT_EXPORT \
+                                                              (uint16_t)(id), (uint8_t)(initState), 1U }
+
+/* Static initializer for an instance, same as fsmInit(). */
+#define FSM_HANDLE_INIT(fsmDef, initState, context)  FSM_HANDLE_INIT_ID((fsmDef), (initState), (context), 0U)
+
+/* Define a const definition <name>Def of a state table array and an instance
+ * <name> of it, both are ready without any call at boot. */
+#define FSM_DEFINE(name, table, initState, context)  static const FsmDef_t name##Def = FSM_DEF_INIT(table); \
+                                                     FsmHandle_t name = FSM_HANDLE_INIT(&name##Def, (initState), (context))
+
+int8_t fsmDefInit(FsmDef_t* fsmDef, FsmStateDef_t* table, const uint8_t nrOfStates);
+int8_t fsmAdd(FsmDef_t* fsmDef, const uint8_t state, FsmStateFunc_t stateFunc, FsmOnEntryFunc_t onEntryFunc, FsmOnExitFunc_t onExitFunc, const uint32_t timeout);
+int8_t fsmDefSetTransitions(FsmDef_t* fsmDef, const FsmTransition_t* transitions, const uint16_t nrOfTransitions, uint16_t* transitionIndex);
+void fsmDefSetErrorFunc(FsmDef_t* fsmDef, FsmErrorFunc_t* errorFunc);
+int8_t fsmDefSetHierarchy(FsmDef_t* fsmDef, const uint8_t* parents, uint8_t* lca);
+void fsmDefSetCoalesceMask(FsmDef_t* fsmDef, const uint32_t* coalesceMask);
+void fsmDefSetInputGuards(FsmDef_t* fsmDef, const FsmInputGuard_t* inputGuards);
+#if (FSM_PROFILING != 0)
+int8_t fsmDefSetBudget(FsmDef_t* fsmDef, const uint8_t state, const uint32_t budget);
+#endif
+uint8_t fsmStateIsValid(const FsmDef_t* fsmDef, const uint8_t state);
+int8_t fsmInit(FsmHandle_t* fsmHandle, const FsmDef_t* fsmDef, const uint8_t initState, void* context);
+void fsmSetId(FsmHandle_t* fsmHandle, const uint16_t id);
+void fsmSetMaxSteps(FsmHandle_t* fsmHandle, const uint8_t maxSteps);
+void fsmDispatch(FsmHandle_t* fsmHandle, const FsmEvent_t event);
+uint8_t fsmRun(FsmHandle_t* fsmHandle);
+#if (FSM_INPUT_GUARDS != 0)
+void fsmSetInputs(FsmHandle_t* fsmHandle, const uint32_t inputs);
+#endif
+#if (FSM_DEFERRED != 0)
+int8_t fsmAttachDeferLog(FsmHandle_t* fsmHandle, FsmDeferLog_t* deferLog, uint8_t* states, const uint8_t size);
+void fsmCommit(FsmHandle_t* fsmHandle);
+#endif
+
+#endif /* FSM_H */
@@ -0,0 +1,330 @@
+/********************************************************************************
+ * @file           : fsm.hpp
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Compile time C++ front end for FSMs
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Header only C++17 front end that generates the fsm at compile time.
+ * States and their functions are template parameters, so the compiler
+ * knows every call target: the dispatch becomes a switch (or jump table)
+ * over the state ids with all state, entry and exit functions inlined,
+ * and states without entry / exit function cost nothing. There is no
+ * state table and no indirect call at runtime.
+ *
+ * The semantics are the same as fsmInit() / fsmAdd() / fsmRun():
+ *   - the init state is executed first without entry function, an unknown
+ *     init state sets state 0 and init() returns -1
+ *   - every run() executes the current state with FSM_EVENT_TICK, in run
+ *     to completion mode again while the state changes (up to maxSteps
+ *     times, see setMaxSteps()), dispatch() executes it once with an event
+ *   - on a state change the exit function of the current state and the
+ *     entry function of the next state are called
+ *   - a next state that was not registered keeps the current state
+ *     (as FSM_CHECK_NEXT_STATE without error function)
+ *
+ * Differences to the C interface: states have no timeout, so
+ * FSM_EVENT_TIMEOUT is only received if the application dispatches it
+ * (e.g. from its own timer). The constructor can not return the result of
+ * the init state check, call init() to get it.
+ *
+ * State functions get a reference to the context of the instance instead
+ * of a void pointer. Timers, queues, transition tables and hierarchy are
+ * only available with the C interface (FsmHandle_t). The C headers of
+ * these modules can be included from C++ in an extern "C" block, their
+ * atomic members are std::atomic there (see FSM_ATOMIC() in fsm.h).
+ *
+ * Example usage:
+ *
+ *     struct Led
+ *     {
+ *         bool buttonPressed;
+ *     };
+ *
+ *     enum : uint8_t
+ *     {
+ *         FSM_STATE_INIT,
+ *         FSM_STATE_INACTIVE,
+ *         FSM_STATE_ACTIVE,
+ *     };
+ *
+ *     static uint8_t StateInit(Led& led, const FsmEvent_t event)
+ *     {
+ *         return FSM_STATE_INACTIVE;
+ *     }
+ *
+ *     static uint8_t StateInactive(Led& led, const FsmEvent_t event)
+ *     {
+ *         return led.buttonPressed ? FSM_STATE_ACTIVE : FSM_STATE_INACTIVE;
+ *     }
+ *
+ *     static uint8_t StateActive(Led& led, const FsmEvent_t event)
+ *     {
+ *         return led.buttonPressed ? FSM_STATE_ACTIVE : FSM_STATE_INACTIVE;
+ *     }
+ *
+ *     static void OnEntryActive(Led& led)
+ *     {
+ *         gpioSet(LED1_PORT, LED1_PIN, GPIO_PIN_SET);
+ *     }
+ *
+ *     static void OnExitActive(Led& led)
+ *     {
+ *         gpioSet(LED1_PORT, LED1_PIN, GPIO_PIN_RESET);
+ *     }
+ *
+ *     using LedFsm = fsm::Machine<Led,
+ *                                 fsm::State<FSM_STATE_INIT,     StateInit>,
+ *                                 fsm::State<FSM_STATE_INACTIVE, StateInactive>,
+ *                                 fsm::State<FSM_STATE_ACTIVE,   StateActive, OnEntryActive, OnExitActive>>;
+ *
+ *     static Led led;
+ *     static LedFsm ledFsm(led, FSM_STATE_INIT);
+ *
+ *     while (1)
+ *     {
+ *         ledFsm.run();
+ *     }
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_HPP
+#define FSM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+extern "C"
+{
+#include "fsm.h"
+}
+
+namespace fsm
+{
+
+namespace detail
+{
+
+/**
+ * @brief Check if all state ids are different (compile time).
+ *
+ * @tparam Ids - state ids
+ * @return true - ids are unique
+ */
+template <uint8_t... Ids>
+constexpr bool idsAreUnique()
+{
+    constexpr uint8_t ids[] = { Ids... };
+    bool unique = true;
+
+    for (std::size_t i = 0; i < sizeof...(Ids); i++)
+    {
+        for (std::size_t j = i + 1; j < sizeof...(Ids); j++)
+        {
+            unique = unique && (ids[i] != ids[j]);
+        }
+    }
+    return unique;
+}
+
+} /* namespace detail */
+
+/**
+ * @brief State of a compile time fsm.
+ *
+ * @tparam Id - state id (0 - 254)
+ * @tparam StateFunc - uint8_t (Context&, FsmEvent_t), returns the next state
+ * @tparam OnEntryFunc - void (Context&) called when entering the state, nullptr for none
+ * @tparam OnExitFunc - void (Context&) called when leaving the state, nullptr for none
+ */
+template <uint8_t Id, auto StateFunc, auto OnEntryFunc = nullptr, auto OnExitFunc = nullptr>
+struct State
+{
+    static_assert(Id != FSM_UNHANDLED, "state id 255 is reserved");
+
+    static constexpr uint8_t id = Id;
+    static constexpr bool hasEntry = !std::is_same_v<decltype(OnEntryFunc), std::nullptr_t>;
+    static constexpr bool hasExit = !std::is_same_v<decltype(OnExitFunc), std::nullptr_t>;
+
+    template <typename Context>
+    static uint8_t execute(Context& context, const FsmEvent_t event)
+    {
+        return StateFunc(context, event);
+    }
+
+    template <typename Context>
+    static void enter(Context& context)
+    {
+        if constexpr (hasEntry)
+        {
+            OnEntryFunc(context);
+        }
+    }
+
+    template <typename Context>
+    static void exit(Context& context)
+    {
+        if constexpr (hasExit)
+        {
+            OnExitFunc(context);
+        }
+    }
+};
+
+/**
+ * @brief Fsm instance whose states are known at compile time.
+ *
+ * @tparam Context - type of the instance data passed to all functions
+ * @tparam States - fsm::State<> of every state, ids must be unique
+ */
+template <typename Context, typename... States>
+class Machine
+{
+public:
+    static constexpr uint8_t nrOfStates = sizeof...(States);
+
+    static_assert(sizeof...(States) > 0, "fsm needs at least one state");
+    static_assert(sizeof...(States) < 256, "fsm can hold up to 255 states");
+    static_assert(detail::idsAreUnique<States::id...>(), "state ids must be unique");
+
+    /**
+     * @brief Bind the instance to its context and set the init state
+     *        (as fsmInit(), see init()).
+     *
+     * @param context - instance data, must outlive the instance
+     * @param initState - state that should be started first
+     */
+    Machine(Context& context, const uint8_t initState)
+        : context(context), currentState(0), maxSteps(1)
+    {
+        (void)init(initState);
+    }
+
+    /**
+     * @brief Set the init state (state that is executed first) as fsmInit(),
+     *        one state per run().
+     *
+     * @param initState - state that should be started first
+     * @return  0 - initState was set correctly
+     *         -1 - initState is not a state of the fsm, state 0 is set
+     */
+    int8_t init(const uint8_t initState)
+    {
+        int8_t stateAdded = -1;
+
+        maxSteps = 1;
+        if (isState(initState))
+        {
+            currentState = initState;
+            stateAdded = 0;
+        }
+        else
+        {
+            currentState = 0;
+        }
+        return stateAdded;
+    }
+
+    /**
+     * @brief Set the max number of state executions per run() (as fsmSetMaxSteps()).
+     *
+     * @param steps - max state executions per run(), 0 and 1 = one state per call
+     */
+    void setMaxSteps(const uint8_t steps)
+    {
+        maxSteps = (0 != steps) ? steps : 1;
+    }
+
+    /**
+     * @brief Execute the current state once with the given event (as fsmDispatch()).
+     *
+     * @param event - event that is passed to the state function
+     */
+    void dispatch(const FsmEvent_t event)
+    {
+        const uint8_t state = currentState;
+        uint8_t stateNext = state;
+
+        /* expands to a switch over the state ids */
+        (void)((state == States::id ? (stateNext = States::execute(context, event), true) : false) || ...);
+
+        if ((state != stateNext) && isState(stateNext))
+        {
+            (void)((state == States::id ? (States::exit(context), true) : false) || ...);
+            (void)((stateNext == States::id ? (States::enter(context), true) : false) || ...);
+            currentState = stateNext;
+        }
+    }
+
+    /**
+     * @brief Execute the fsm in polling mode with FSM_EVENT_TICK (as fsmRun()).
+     *        The current state is executed once, in run to completion mode
+     *        again while the state changes (up to maxSteps times).
+     *
+     * @return number of executed states (1 - maxSteps)
+     */
+    uint8_t run()
+    {
+        uint8_t steps = 0;
+        uint8_t state;
+
+        do
+        {
+            state = currentState;
+            dispatch(FSM_EVENT_TICK);
+            steps++;
+        } while ((state != currentState) && (steps < maxSteps));
+
+        return steps;
+    }
+
+    /**
+     * @brief Get the current state.
+     *
+     * @return current state id
+     */
+    uint8_t state() const
+    {
+        return currentState;
+    }
+
+private:
+    static constexpr bool isState(const uint8_t state)
+    {
+        return ((state == States::id) || ...);
+    }
+
+    Context& context;
+    uint8_t currentState;
+    uint8_t maxSteps; /* max state executions per run() call, 1 = one state per call */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_HPP */
@@ -0,0 +1,331 @@
+/********************************************************************************
+ * @file           : fsmBatch.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Run arrays of homogeneous FSM instances in one call
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmBatch.h"
+#include "stddef.h"
+
+/**
+ * @brief Bind an array of instances to a shared definition and set all
+ *        of them to the init state. Single instances can be set to other
+ *        states afterwards through the states array. Instances set to an
+ *        invalid state are passed to the error function of the definition
+ *        on the next dispatch and skipped if it returns no valid state.
+ *
+ * @param batch - batch instance
+ * @param fsmDef - fsm definition used by all instances
+ * @param states - [out] current state of every instance (nrOfFsms items)
+ * @param contexts - context of every instance (nrOfFsms items), may be NULL
+ * @param nrOfFsms - number of instances
+ * @param initState - state that should be started first
+ * @return  0 - batch initialized
+ *         -1 - invalid arrays or init state
+ */
+int8_t fsmBatchInit(FsmBatch_t* batch, const FsmDef_t* fsmDef, uint8_t* states, void** contexts, const uint32_t nrOfFsms, const uint8_t initState)
+{
+    int8_t batchInitialized = -1;
+
+    batch->def = fsmDef;
+    batch->batchFuncs = NULL;
+    batch->states = states;
+    batch->contexts = contexts;
+    batch->order = NULL;
+    batch->groupContexts = NULL;
+    batch->nextStates = NULL;
+    batch->nrOfFsms = 0;
+
+    for (uint16_t state = 0; state < 256U; state++)
+    {
+        batch->groupEnd[state] = 0;
+    }
+
+    if ((NULL != states) && (initState < fsmDef->nrOfStates))
+    {
+        for (uint32_t i = 0; i < nrOfFsms; i++)
+        {
+            states[i] = initState;
+        }
+        batch->nrOfFsms = nrOfFsms;
+        batchInitialized = 0;
+    }
+    return batchInitialized;
+}
+
+/**
+ * @brief Set the working buffers of a batch, each one with one item per
+ *        instance. Must be set before the batch is run.
+ *
+ * @param batch - batch instance
+ * @param order - instance numbers grouped by state
+ * @param groupContexts - contexts grouped by state
+ * @param nextStates - next states grouped by state
+ */
+void fsmBatchSetBuffers(FsmBatch_t* batch, uint32_t* order, void** groupContexts, uint8_t* nextStates)
+{
+    batch->order = order;
+    batch->groupContexts = groupContexts;
+    batch->nextStates = nextStates;
+}
+
+/**
+ * @brief Set the batch functions of the states. States without batch
+ *        function call the state function of the definition per instance.
+ *
+ * @param batch - batch instance
+ * @param batchFuncs - batch function of every state (nrOfStates items, items may be NULL),
+ *                     NULL to only use the state functions of the definition
+ */
+void fsmBatchSetFuncs(FsmBatch_t* batch, FsmBatchFunc_t* const* batchFuncs)
+{
+    batch->batchFuncs = batchFuncs;
+}
+
+/**
+ * @brief Replace the state of an instance that was set to an invalid
+ *        state (out of range or not registered) through the states array.
+ *        The instance has no valid current state, so the error function
+ *        gets the first valid state of the definition as state.
+ *
+ * @param batch - batch instance
+ * @param instance - instance number
+ * @param validMask - bit per valid state of the definition
+ * @param firstValidState - lowest valid state, nrOfStates if there is none
+ * @return 1 - instance has a valid state (from the error function)
+ *         0 - instance has no valid state and is not executed
+ */
+static uint8_t fsmBatchRepairState(FsmBatch_t* batch, const uint32_t instance, const uint32_t* validMask, const uint16_t firstValidState)
+{
+    uint8_t stateValid = 0;
+    const FsmDef_t* fsmDef = batch->def;
+
+    if ((NULL != fsmDef->errorFunc) && (firstValidState < fsmDef->nrOfStates))
+    {
+        uint8_t invalidState = batch->states[instance];
+        void* context = (NULL != batch->contexts) ? batch->contexts[instance] : NULL;
+        uint8_t errorState = fsmDef->errorFunc(context, (uint8_t)firstValidState, invalidState);
+
+        if (0 != (validMask[errorState >> 5] & (1UL << (errorState & 31U))))
+        {
+            batch->states[instance] = errorState;
+            stateValid = 1;
+        }
+    }
+    return stateValid;
+}
+
+/**
+ * @brief Group the instances by their current state (counting sort).
+ *        Afterwards the group of state s is order[groupEnd[s - 1]] -
+ *        order[groupEnd[s] - 1] (starting at 0 for state 0).
+ *        Instances with an invalid state are passed to the error function
+ *        of the definition (with the first valid state as state), if it
+ *        returns no valid state they are skipped.
+ *
+ * @param batch - batch instance
+ */
+static void fsmBatchGroup(FsmBatch_t* batch)
+{
+    uint8_t* states = batch->states;
+    uint16_t nrOfStates = batch->def->nrOfStates;
+    uint32_t* groupEnd = batch->groupEnd;
+    uint32_t validMask[FSM_STATE_MASK_WORDS(256)] = { 0 };
+    uint8_t allValid = 1;
+    uint16_t firstValidState = nrOfStates;
+    uint32_t start = 0;
+
+    for (uint16_t state = 0; state < nrOfStates; state++)
+    {
+        groupEnd[state] = 0;
+        if (0 != fsmStateIsValid(batch->def, (uint8_t)state))
+        {
+            validMask[state >> 5] |= 1UL << (state & 31U);
+            if (firstValidState == nrOfStates)
+            {
+                firstValidState = state;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < batch->nrOfFsms; i++)
+    {
+        if ((0 != (validMask[states[i] >> 5] & (1UL << (states[i] & 31U)))) || (0 != fsmBatchRepairState(batch, i, validMask, firstValidState)))
+        {
+            groupEnd[states[i]]++;
+        }
+        else
+        {
+            allValid = 0;
+        }
+    }
+
+    /* groupEnd[s] = start of group s, it is moved to the end while the group is filled */
+    for (uint16_t state = 0; state < nrOfStates; state++)
+    {
+        uint32_t count = groupEnd[state];
+
+        groupEnd[state] = start;
+        start += count;
+    }
+
+    for (uint32_t i = 0; i < batch->nrOfFsms; i++)
+    {
+        if ((0 != allValid) || (0 != (validMask[states[i] >> 5] & (1UL << (states[i] & 31U)))))
+        {
+            uint32_t position = groupEnd[states[i]]++;
+
+            batch->order[position] = i;
+            batch->groupContexts[position] = (NULL != batch->contexts) ? batch->contexts[i] : NULL;
+        }
+    }
+}
+
+/**
+ * @brief Execute every state once for its group of instances.
+ *
+ * @param batch - batch instance
+ * @param event - event that is passed to the state functions
+ */
+static void fsmBatchExecute(FsmBatch_t* batch, const FsmEvent_t event)
+{
+    const FsmStateDef_t* table = batch->def->table;
+    uint16_t nrOfStates = batch->def->nrOfStates;
+    uint32_t start = 0;
+
+    for (uint16_t state = 0; state < nrOfStates; state++)
+    {
+        uint32_t end = batch->groupEnd[state];
+        void* const* contexts = &batch->groupContexts[start];
+        uint8_t* nextStates = &batch->nextStates[start];
+        uint32_t count = end - start;
+
+        if (0 == count)
+        {
+            /* state is not occupied */
+        }
+        else if ((NULL != batch->batchFuncs) && (NULL != batch->batchFuncs[state]))
+        {
+            batch->batchFuncs[state](contexts, nextStates, count, event);
+        }
+        else if (NULL != table[state].stateFunc)
+        {
+            FsmStateFunc_t* stateFunc = table[state].stateFunc;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                nextStates[i] = stateFunc(contexts[i], event);
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                nextStates[i] = (uint8_t)state;
+            }
+        }
+        start = end;
+    }
+}
+
+/**
+ * @brief Execute all instances of the batch once with the given event.
+ *        Entry and exit functions of the definition are called for every
+ *        instance that changes its state.
+ *
+ * @param batch - batch instance, buffers must be set
+ * @param event - event that is passed to the state functions
+ * @return number of instances that changed their state
+ */
+uint32_t fsmBatchDispatch(FsmBatch_t* batch, const FsmEvent_t event)
+{
+    const FsmDef_t* fsmDef = batch->def;
+    uint16_t nrOfStates = fsmDef->nrOfStates;
+    uint32_t nrOfTransitions = 0;
+    uint32_t start = 0;
+
+    fsmBatchGroup(batch);
+    fsmBatchExecute(batch, event);
+
+    for (uint16_t state = 0; state < nrOfStates; state++)
+    {
+        uint32_t end = batch->groupEnd[state];
+
+        for (uint32_t i = start; i < end; i++)
+        {
+            uint8_t stateNext = batch->nextStates[i];
+            void* context = batch->groupContexts[i];
+
+            if (state != stateNext)
+            {
+#if (FSM_CHECK_NEXT_STATE != 0)
+                if (0 == fsmStateIsValid(fsmDef, stateNext))
+                {
+                    stateNext = (uint8_t)state;
+                    if (NULL != fsmDef->errorFunc)
+                    {
+                        uint8_t errorState = fsmDef->errorFunc(context, (uint8_t)state, batch->nextStates[i]);
+
+                        if (0 != fsmStateIsValid(fsmDef, errorState))
+                        {
+                            stateNext = errorState;
+                        }
+                    }
+                }
+#endif
+                if (state != stateNext)
+                {
+                    if (NULL != fsmDef->table[state].onExitFunc)
+                    {
+                        fsmDef->table[state].onExitFunc(context);
+                    }
+                    if (NULL != fsmDef->table[stateNext].onEntryFunc)
+                    {
+                        fsmDef->table[stateNext].onEntryFunc(context);
+                    }
+                    batch->states[batch->order[i]] = stateNext;
+                    nrOfTransitions++;
+                }
+            }
+        }
+        start = end;
+    }
+    return nrOfTransitions;
+}
+
+/**
+ * @brief Execute all instances of the batch once in polling mode
+ *        (dispatch FSM_EVENT_TICK).
+ *
+ * @param batch - batch instance, buffers must be set
+ * @return number of instances that changed their state
+ */
+uint32_t fsmBatchRun(FsmBatch_t* batch)
+{
+    return fsmBatchDispatch(batch, FSM_EVENT_TICK);
+}
@@ -0,0 +1,123 @@
+/********************************************************************************
+ * @file           : fsmBatch.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Run arrays of homogeneous FSM instances in one call
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Runs many instances of one definition (e.g. thousands of simulated devices)
+ * in one call. The current states are kept in one packed array
+ * (struct of arrays) instead of one handle per instance. On every call the
+ * instances are grouped by their current state (counting sort) and each
+ * state is executed once for its whole group with a span of instance
+ * contexts. Instead of one indirect call and a table lookup per instance,
+ * the work is one call per occupied state over contiguous arrays.
+ *
+ * A state can have a batch function that handles the whole group at once.
+ * States without batch function call the state function of the definition
+ * for every instance of the group, which is still a tight loop with the
+ * same call target. Transitions call the exit and entry functions of the
+ * definition per instance. Transition tables, hierarchy, timers and queues
+ * are not used by the batch, those need a FsmHandle_t per instance.
+ * Instances that were set to an invalid state through the states array are
+ * passed to the error function of the definition before they are grouped.
+ * They have no valid current state, so the error function gets the first
+ * valid state of the definition as state (and the invalid state as
+ * invalidState), an error function that returns state moves them there.
+ *
+ * All arrays are provided by the user, no dynamic memory allocation is used.
+ *
+ * Example usage:
+ *
+ *     static uint8_t deviceStates[NR_OF_DEVICES];
+ *     static void* deviceContexts[NR_OF_DEVICES];
+ *     static uint32_t deviceOrder[NR_OF_DEVICES];
+ *     static void* deviceGroupContexts[NR_OF_DEVICES];
+ *     static uint8_t deviceNextStates[NR_OF_DEVICES];
+ *     static FsmBatch_t deviceBatch;
+ *
+ *     static void BatchConnected(void* const* contexts, uint8_t* nextStates, const uint32_t count, const FsmEvent_t event)
+ *     {
+ *         for (uint32_t i = 0; i < count; i++)
+ *         {
+ *             Device_t* device = (Device_t*)contexts[i];
+ *
+ *             nextStates[i] = (device->linkUp) ? DEVICE_STATE_CONNECTED : DEVICE_STATE_OFFLINE;
+ *         }
+ *     }
+ *
+ *     static FsmBatchFunc_t* const deviceBatchFuncs[NR_OF_DEVICE_STATES] =
+ *     {
+ *         [DEVICE_STATE_CONNECTED] = BatchConnected,
+ *     };
+ *
+ *     for (uint32_t i = 0; i < NR_OF_DEVICES; i++)
+ *     {
+ *         deviceContexts[i] = &devices[i];
+ *     }
+ *     fsmBatchInit(&deviceBatch, &deviceFsmDef, deviceStates, deviceContexts, NR_OF_DEVICES, DEVICE_STATE_INIT);
+ *     fsmBatchSetBuffers(&deviceBatch, deviceOrder, deviceGroupContexts, deviceNextStates);
+ *     fsmBatchSetFuncs(&deviceBatch, deviceBatchFuncs);
+ *
+ *     while (1)
+ *     {
+ *         fsmBatchRun(&deviceBatch);
+ *     }
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_BATCH_H
+#define FSM_BATCH_H
+
+#include "stdint.h"
+#include "fsm.h"
+
+/* Execute a state for a group of instances: contexts[i] is the context of
+ * instance i of the group, nextStates[i] must be set to its next state. */
+typedef void FsmBatchFunc_t(void* const* contexts, uint8_t* nextStates, const uint32_t count, const FsmEvent_t event);
+
+typedef struct
+{
+    const FsmDef_t* def;
+    FsmBatchFunc_t* const* batchFuncs; /* batch function of every state (may be NULL items), NULL for none */
+    uint8_t* states;                   /* current state of every instance */
+    void** contexts;                   /* context of every instance, NULL if not used */
+    uint32_t* order;                   /* instance numbers grouped by state */
+    void** groupContexts;              /* contexts grouped by state */
+    uint8_t* nextStates;               /* next states grouped by state */
+    uint32_t nrOfFsms;
+    uint32_t groupEnd[256];            /* end of the group of every state in order */
+} FsmBatch_t;
+
+int8_t fsmBatchInit(FsmBatch_t* batch, const FsmDef_t* fsmDef, uint8_t* states, void** contexts, const uint32_t nrOfFsms, const uint8_t initState);
+void fsmBatchSetBuffers(FsmBatch_t* batch, uint32_t* order, void** groupContexts, uint8_t* nextStates);
+void fsmBatchSetFuncs(FsmBatch_t* batch, FsmBatchFunc_t* const* batchFuncs);
+uint32_t fsmBatchDispatch(FsmBatch_t* batch, const FsmEvent_t event);
+uint32_t fsmBatchRun(FsmBatch_t* batch);
+
+#endif /* FSM_BATCH_H */
@@ -0,0 +1,131 @@
+/********************************************************************************
+ * @file           : fsmCoro.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Coroutine states for FSMs
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Coroutine states: a state function that runs a sequence (send a command,
+ * wait for the answer, send the next one, ...) and suspends at the wait
+ * points, instead of one state per step. The resume point is kept in the
+ * context of the instance (FsmCoro_t), the next fsmRun() / fsmDispatch()
+ * jumps straight to it. One logical phase stays one state: the state table,
+ * timeouts and transitions stay small, and a step costs one switch jump.
+ *
+ * The coroutine is stackless (protothread style):
+ *   - local variables do not survive a wait, keep them in the context
+ *   - no switch statement in the coroutine body (if / else is fine)
+ *   - code in front of FSM_CORO_BEGIN() runs on every call, e.g. to leave
+ *     the state on FSM_EVENT_TIMEOUT (the state timeout covers the whole
+ *     sequence)
+ *
+ * FSM_CORO_EXIT() resets the resume point. If the state can also be left
+ * by a transition of the transition table or a parent state, the entry
+ * function of the state has to reset it (FSM_CORO_RESET()), so the next
+ * visit starts at the beginning.
+ *
+ * Example usage:
+ *
+ *     typedef struct
+ *     {
+ *         FsmCoro_t coro;
+ *         uint8_t retries;
+ *     } Modem_t;
+ *
+ *     static void OnEntryModemInit(void* context)
+ *     {
+ *         Modem_t* modem = context;
+ *
+ *         FSM_CORO_RESET(&modem->coro);
+ *         modem->retries = 0;
+ *     }
+ *
+ *     static uint8_t StateModemInit(void* context, const FsmEvent_t event)
+ *     {
+ *         Modem_t* modem = context;
+ *
+ *         if (FSM_EVENT_TIMEOUT == event)
+ *         {
+ *             FSM_CORO_EXIT(&modem->coro, MODEM_STATE_ERROR);
+ *         }
+ *
+ *         FSM_CORO_BEGIN(&modem->coro, MODEM_STATE_INIT);
+ *
+ *         uartSend("AT\r");
+ *         FSM_CORO_YIELD_UNTIL(&modem->coro, EVENT_MODEM_OK == event);
+ *
+ *         uartSend("ATE0\r");
+ *         FSM_CORO_YIELD_UNTIL(&modem->coro, EVENT_MODEM_OK == event);
+ *
+ *         uartSend("AT+CFUN=1\r");
+ *         FSM_CORO_WAIT_UNTIL(&modem->coro, modemIsRegistered());
+ *
+ *         FSM_CORO_EXIT(&modem->coro, MODEM_STATE_READY);
+ *
+ *         FSM_CORO_END(&modem->coro);
+ *     }
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_CORO_H
+#define FSM_CORO_H
+
+#include "stdint.h"
+#include "fsm.h"
+
+/* Resume point of a coroutine state (source line of the wait point), 0 = start. */
+typedef uint16_t FsmCoro_t;
+
+/* Start the coroutine from the beginning on the next call. */
+#define FSM_CORO_RESET(coro)  (*(coro) = 0U)
+
+/* Start of the coroutine body, state is the state that runs the coroutine
+ * (returned while the coroutine waits). */
+#define FSM_CORO_BEGIN(coro, state)  { const uint8_t fsmCoroState = (uint8_t)(state); \
+                                       switch (*(coro)) { case 0U:
+
+/* Suspend and stay in the state, the next call resumes behind the yield. */
+#define FSM_CORO_YIELD(coro)  do { *(coro) = (FsmCoro_t)__LINE__; return fsmCoroState; case __LINE__:; } while (0)
+
+/* Suspend and stay in the state until the condition is true, the condition
+ * is checked on this and every following call (e.g. on the dispatched event). */
+#define FSM_CORO_WAIT_UNTIL(coro, condition)  do { *(coro) = (FsmCoro_t)__LINE__; if (0) { case __LINE__:; } \
+                                                   if (!(condition)) { return fsmCoroState; } } while (0)
+
+/* Suspend at least once, then stay in the state until the condition is true,
+ * e.g. to wait for the next event (the current event is not checked). */
+#define FSM_CORO_YIELD_UNTIL(coro, condition)  do { *(coro) = (FsmCoro_t)__LINE__; return fsmCoroState; case __LINE__: \
+                                                    if (!(condition)) { return fsmCoroState; } } while (0)
+
+/* Leave the coroutine to the next state, the next visit starts at the beginning. */
+#define FSM_CORO_EXIT(coro, nextState)  do { *(coro) = 0U; return (nextState); } while (0)
+
+/* End of the coroutine body, reaching it restarts the coroutine on the next call. */
+#define FSM_CORO_END(coro)  } *(coro) = 0U; return fsmCoroState; }
+
+#endif /* FSM_CORO_H */
@@ -0,0 +1,312 @@
+/********************************************************************************
+ * @file           : fsmExec.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Multi-core executor for FSM instances with work stealing
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmExec.h"
+#include "fsmQueue.h"
+#include "stddef.h"
+
+/* Task states, an instance is only executed in FSM_EXEC_RUNNING / FSM_EXEC_NOTIFIED. */
+#define FSM_EXEC_IDLE      0U /* not ready */
+#define FSM_EXEC_QUEUED    1U /* in the run queue of its owner */
+#define FSM_EXEC_RUNNING   2U /* executed by a worker */
+#define FSM_EXEC_NOTIFIED  3U /* executed by a worker, ready again after the run */
+
+/*
+ * The run queues are bounded queues with a sequence number per slot
+ * (D. Vyukov, as fsmQueue.c) with several producers (notify hooks) and
+ * several consumers (the owner and stealing workers). A task is at most
+ * once in a run queue, so a queue with maxNrOfFsms slots never overflows.
+ */
+
+/**
+ * @brief Put a task into a run queue.
+ *
+ * @param worker - worker that owns the run queue
+ * @param id - task id
+ */
+static void fsmExecPush(FsmExecWorker_t* worker, const uint16_t id)
+{
+    uint32_t pos = atomic_load_explicit(&worker->head, memory_order_relaxed);
+
+    while (1)
+    {
+        FsmExecSlot_t* slot = &worker->slots[pos & worker->mask];
+        int32_t diff = (int32_t)(atomic_load_explicit(&slot->sequence, memory_order_acquire) - pos);
+
+        if ((0 == diff) &&
+            atomic_compare_exchange_weak_explicit(&worker->head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+        {
+            slot->id = id;
+            atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+            break;
+        }
+        else if (0 != diff)
+        {
+            /* slot taken by another producer (or not yet released by a consumer), retry */
+            pos = atomic_load_explicit(&worker->head, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Take the oldest task from a run queue.
+ *
+ * @param worker - worker that owns the run queue
+ * @param id - [out] task id
+ * @return  0 - task taken
+ *         -1 - run queue is empty
+ */
+static int8_t fsmExecPop(FsmExecWorker_t* worker, uint16_t* id)
+{
+    int8_t taskTaken = -1;
+    uint32_t pos = atomic_load_explicit(&worker->tail, memory_order_relaxed);
+
+    while (1)
+    {
+        FsmExecSlot_t* slot = &worker->slots[pos & worker->mask];
+        int32_t diff = (int32_t)(atomic_load_explicit(&slot->sequence, memory_order_acquire) - (pos + 1));
+
+        if (0 == diff)
+        {
+            if (atomic_compare_exchange_weak_explicit(&worker->tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                *id = slot->id;
+                atomic_store_explicit(&slot->sequence, pos + worker->mask + 1, memory_order_release);
+                taskTaken = 0;
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            break; /* empty */
+        }
+        else
+        {
+            pos = atomic_load_explicit(&worker->tail, memory_order_relaxed);
+        }
+    }
+    return taskTaken;
+}
+
+#if (FSM_QUEUE != 0)
+/**
+ * @brief Notify hook of the instances, marks the instance ready.
+ *
+ * @param notifyArg - executor instance
+ * @param id - executor id of the fsm instance
+ */
+static void fsmExecNotify(void* notifyArg, const uint16_t id)
+{
+    fsmExecSetReady((FsmExec_t*)notifyArg, id);
+}
+#endif
+
+/**
+ * @brief Initialize an executor.
+ *
+ * @param exec - executor instance
+ * @param tasks - task array with maxNrOfFsms items
+ * @param maxNrOfFsms - max number of fsm instances, power of two (2 - 32768)
+ * @param workers - worker array with nrOfWorkers items
+ * @param slots - run queue slots with nrOfWorkers * maxNrOfFsms items
+ * @param nrOfWorkers - number of worker threads / cores
+ * @return  0 - executor initialized
+ *         -1 - invalid arrays or sizes
+ */
+int8_t fsmExecInit(FsmExec_t* exec, FsmExecTask_t* tasks, const uint16_t maxNrOfFsms,
+                   FsmExecWorker_t* workers, FsmExecSlot_t* slots, const uint16_t nrOfWorkers)
+{
+    int8_t execInitialized = -1;
+
+    if ((NULL != tasks) && (NULL != workers) && (NULL != slots) && (nrOfWorkers > 0) &&
+        (maxNrOfFsms >= 2) && (maxNrOfFsms <= 32768U) && (0 == (maxNrOfFsms & (maxNrOfFsms - 1))))
+    {
+        for (uint16_t w = 0; w < nrOfWorkers; w++)
+        {
+            workers[w].slots = &slots[(uint32_t)w * maxNrOfFsms];
+            workers[w].mask = (uint32_t)maxNrOfFsms - 1;
+            atomic_init(&workers[w].head, 0);
+            atomic_init(&workers[w].tail, 0);
+
+            for (uint16_t i = 0; i < maxNrOfFsms; i++)
+            {
+                atomic_init(&workers[w].slots[i].sequence, i);
+                workers[w].slots[i].id = 0;
+            }
+        }
+        exec->tasks = tasks;
+        exec->workers = workers;
+        exec->nrOfFsms = 0;
+        exec->maxNrOfFsms = maxNrOfFsms;
+        exec->nrOfWorkers = nrOfWorkers;
+        execInitialized = 0;
+    }
+    return execInitialized;
+}
+
+/**
+ * @brief Add a fsm instance to the executor. Events posted to the
+ *        instance queue mark it ready. Must be called before the workers
+ *        are started, after fsmInit() and fsmAttachQueue().
+ *
+ * @param exec - executor instance
+ * @param fsmHandle - fsm instance
+ * @param worker - worker that owns the instance (0 - nrOfWorkers - 1)
+ * @return >= 0 - executor id of the instance
+ *           -1 - executor is full or invalid worker
+ */
+int16_t fsmExecAdd(FsmExec_t* exec, FsmHandle_t* fsmHandle, const uint16_t worker)
+{
+    int16_t id = -1;
+
+    if ((exec->nrOfFsms < exec->maxNrOfFsms) && (worker < exec->nrOfWorkers))
+    {
+        FsmExecTask_t* task = &exec->tasks[exec->nrOfFsms];
+
+        id = (int16_t)exec->nrOfFsms;
+        task->fsmHandle = fsmHandle;
+        task->owner = worker;
+        atomic_init(&task->state, FSM_EXEC_IDLE);
+        fsmHandle->id = (uint16_t)id;
+#if (FSM_QUEUE != 0)
+        fsmHandle->notifyArg = exec;
+        fsmHandle->notifyFunc = fsmExecNotify;
+#endif
+        exec->nrOfFsms++;
+    }
+    return id;
+}
+
+/**
+ * @brief Mark a fsm instance ready, it is put into the run queue of its
+ *        owner. Can be called from any thread.
+ *
+ * @param exec - executor instance
+ * @param id - executor id of the fsm instance
+ */
+void fsmExecSetReady(FsmExec_t* exec, const uint16_t id)
+{
+    if (id < exec->nrOfFsms)
+    {
+        FsmExecTask_t* task = &exec->tasks[id];
+        uint8_t state;
+        uint8_t done = 0;
+
+        /* the posted event must be visible before the state is read (see fsmExecRunNext()) */
+        atomic_thread_fence(memory_order_seq_cst);
+        state = atomic_load_explicit(&task->state, memory_order_acquire);
+
+        while (0 == done)
+        {
+            if (FSM_EXEC_IDLE == state)
+            {
+                if (atomic_compare_exchange_weak_explicit(&task->state, &state, FSM_EXEC_QUEUED,
+                                                          memory_order_acq_rel, memory_order_acquire))
+                {
+                    fsmExecPush(&exec->workers[task->owner], id);
+                    done = 1;
+                }
+            }
+            else if (FSM_EXEC_RUNNING == state)
+            {
+                if (atomic_compare_exchange_weak_explicit(&task->state, &state, FSM_EXEC_NOTIFIED,
+                                                          memory_order_acq_rel, memory_order_acquire))
+                {
+                    done = 1;
+                }
+            }
+            else
+            {
+                done = 1; /* already queued or notified */
+            }
+        }
+    }
+}
+
+/**
+ * @brief Take the next ready fsm instance of a worker (or steal one from
+ *        another worker) and execute it: drain its queue once, or
+ *        fsmRun() if the instance has no queue.
+ *
+ * @param exec - executor instance
+ * @param worker - index of the calling worker
+ * @return >= 0 - executor id of the executed instance
+ *           -1 - no instance is ready
+ */
+int16_t fsmExecRunNext(FsmExec_t* exec, const uint16_t worker)
+{
+    int16_t taskId = -1;
+    uint16_t id = 0;
+    int8_t taskTaken = fsmExecPop(&exec->workers[worker], &id);
+
+    /* steal from the other workers, starting with the next one */
+    for (uint16_t i = 1; (0 != taskTaken) && (i < exec->nrOfWorkers); i++)
+    {
+        taskTaken = fsmExecPop(&exec->workers[(worker + i) % exec->nrOfWorkers], &id);
+    }
+
+    if (0 == taskTaken)
+    {
+        FsmExecTask_t* task = &exec->tasks[id];
+        FsmHandle_t* fsmHandle = task->fsmHandle;
+        uint8_t state = FSM_EXEC_RUNNING;
+        uint8_t ready;
+
+        /* queued -> running, notify hooks only change running tasks afterwards. Either the
+         * worker sees the events posted before the fence or the notify hook sees running. */
+        atomic_store_explicit(&task->state, FSM_EXEC_RUNNING, memory_order_release);
+        atomic_thread_fence(memory_order_seq_cst);
+
+#if (FSM_QUEUE != 0)
+        if (NULL != fsmHandle->queue)
+        {
+            (void)fsmProcess(fsmHandle);
+            ready = (0 == fsmQueueIsEmpty(fsmHandle->queue)) ? 1 : 0;
+        }
+        else
+#endif
+        {
+            (void)fsmRun(fsmHandle);
+            ready = 0;
+        }
+
+        if ((0 != ready) ||
+            !atomic_compare_exchange_strong_explicit(&task->state, &state, FSM_EXEC_IDLE,
+                                                     memory_order_acq_rel, memory_order_acquire))
+        {
+            /* notified while running (or events left), run again */
+            atomic_store_explicit(&task->state, FSM_EXEC_QUEUED, memory_order_release);
+            fsmExecPush(&exec->workers[task->owner], id);
+        }
+        taskId = (int16_t)id;
+    }
+    return taskId;
+}
@@ -0,0 +1,144 @@
+/********************************************************************************
+ * @file           : fsmExec.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Multi-core executor for FSM instances with work stealing
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Executor that runs fsm instances on several worker threads or cores.
+ * Every instance is owned by one worker (sharding), every worker has its
+ * own run queue of ready instances. An event posted to an instance
+ * (fsmPost() / fsmPostMulti()) puts the instance into the run queue of
+ * its owner, there is no global lock or global queue. A worker without
+ * ready instances steals them from the run queues of the other workers,
+ * so a busy worker is relieved without moving the ownership.
+ *
+ * An instance is never executed by two workers at the same time: it is
+ * at most once in a run queue and its task state (idle, queued, running,
+ * running and notified) is switched with atomic compare-and-swap. Events
+ * posted while the instance runs mark it notified, it is queued again
+ * after the run, so no event is lost. Every run drains the instance
+ * queue once (see fsmProcess()), instances without queue are executed
+ * with fsmRun(). Queues and the notify hook of the instances need
+ * FSM_QUEUE = 1, without it the instances are only marked ready with
+ * fsmExecSetReady().
+ *
+ * The executor does not create threads. Every worker thread (or core)
+ * calls fsmExecRunNext() with its worker index in a loop and sleeps /
+ * yields if nothing is ready. Every run queue has maxNrOfFsms slots, so
+ * it never overflows. The executor needs C11 atomics with compare-and-swap
+ * (not available on Cortex-M0). The timer wheel (fsmTimer.h) is not thread
+ * safe, instances that run on the executor must not use state timeouts.
+ *
+ * Example usage (POSIX threads):
+ *
+ *     static FsmExecTask_t execTasks[NR_OF_FSMS];
+ *     static FsmExecWorker_t execWorkers[NR_OF_WORKERS];
+ *     static FsmExecSlot_t execSlots[NR_OF_WORKERS * NR_OF_FSMS];
+ *     static FsmExec_t exec;
+ *
+ *     static void* worker(void* arg)
+ *     {
+ *         uint16_t index = (uint16_t)(uintptr_t)arg;
+ *
+ *         while (1)
+ *         {
+ *             if (fsmExecRunNext(&exec, index) < 0)
+ *             {
+ *                 sched_yield();
+ *             }
+ *         }
+ *         return NULL;
+ *     }
+ *
+ *     fsmExecInit(&exec, execTasks, NR_OF_FSMS, execWorkers, execSlots, NR_OF_WORKERS);
+ *     for (uint16_t i = 0; i < NR_OF_FSMS; i++)
+ *     {
+ *         fsmExecAdd(&exec, &deviceFsm[i], i % NR_OF_WORKERS);
+ *     }
+ *     for (uintptr_t i = 0; i < NR_OF_WORKERS; i++)
+ *     {
+ *         pthread_create(&threads[i], NULL, worker, (void*)i);
+ *     }
+ *
+ *     fsmPostMulti(&deviceFsm[7], EVENT_RX); // from any thread
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_EXEC_H
+#define FSM_EXEC_H
+
+#include "stdint.h"
+#ifndef __cplusplus
+#include "stdatomic.h"
+#endif
+#include "fsm.h"
+
+/* Size of a cache line, the run queues of the workers are aligned to it
+ * so the workers do not share cache lines. */
+#ifndef FSM_EXEC_CACHE_LINE
+#define FSM_EXEC_CACHE_LINE  64
+#endif
+
+typedef struct
+{
+    FSM_ATOMIC(uint32_t) sequence;
+    uint16_t id;
+} FsmExecSlot_t;
+
+typedef struct
+{
+    FSM_ALIGNAS(FSM_EXEC_CACHE_LINE) FSM_ATOMIC(uint32_t) head;
+    FSM_ALIGNAS(FSM_EXEC_CACHE_LINE) FSM_ATOMIC(uint32_t) tail;
+    FsmExecSlot_t* slots;
+    uint32_t mask;
+} FsmExecWorker_t;
+
+typedef struct
+{
+    FsmHandle_t* fsmHandle;
+    FSM_ATOMIC(uint8_t) state; /* idle, queued, running, running and notified */
+    uint16_t owner;        /* worker that owns the instance */
+} FsmExecTask_t;
+
+typedef struct
+{
+    FsmExecTask_t* tasks;
+    FsmExecWorker_t* workers;
+    uint16_t nrOfFsms;
+    uint16_t maxNrOfFsms;
+    uint16_t nrOfWorkers;
+} FsmExec_t;
+
+int8_t fsmExecInit(FsmExec_t* exec, FsmExecTask_t* tasks, const uint16_t maxNrOfFsms,
+                   FsmExecWorker_t* workers, FsmExecSlot_t* slots, const uint16_t nrOfWorkers);
+int16_t fsmExecAdd(FsmExec_t* exec, FsmHandle_t* fsmHandle, const uint16_t worker);
+void fsmExecSetReady(FsmExec_t* exec, const uint16_t id);
+int16_t fsmExecRunNext(FsmExec_t* exec, const uint16_t worker);
+
+#endif /* FSM_EXEC_H */
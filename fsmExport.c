@@ -0,0 +1,168 @@
+/********************************************************************************
+ * @file           : fsmExport.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Seqlock shared memory export of FSM instance states
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmExport.h"
+
+/**
+ * @brief Initialize an export region (e.g. in shared memory) with empty slots.
+ *
+ * @param region - region of FSM_EXPORT_REGION_SIZE(nrOfSlots) bytes
+ * @param nrOfSlots - number of slots (1 - UINT32_MAX)
+ * @return  0 - region initialized
+ *         -1 - invalid region or number of slots
+ */
+int8_t fsmExportInit(FsmExportRegion_t* region, const uint32_t nrOfSlots)
+{
+    int8_t regionInitialized = -1;
+
+    if ((NULL != region) && (0 != nrOfSlots))
+    {
+        for (uint32_t i = 0; i < nrOfSlots; i++)
+        {
+            FsmExportSlot_t* slot = &region->slots[i];
+
+            atomic_init(&slot->sequence, 0);
+            atomic_init(&slot->transitions, 0);
+            atomic_init(&slot->timestamp, 0);
+            atomic_init(&slot->id, 0);
+            atomic_init(&slot->state, 0);
+            atomic_init(&slot->attached, 0);
+        }
+
+        region->version = FSM_EXPORT_VERSION;
+        region->slotSize = (uint16_t)sizeof(FsmExportSlot_t);
+        region->nrOfSlots = nrOfSlots;
+        region->reserved = 0;
+        /* written last, readers check it before the rest of the header */
+        atomic_thread_fence(memory_order_release);
+        region->magic = FSM_EXPORT_MAGIC;
+        regionInitialized = 0;
+    }
+    return regionInitialized;
+}
+
+/**
+ * @brief Attach an export slot to a fsm instance and publish its current
+ *        state. The transition counter of the slot starts at 0. Set the id
+ *        of the instance first (fsmSetId(), fsmSchedAdd()), it is published
+ *        with the state. Without FSM_EXPORT the call has no effect.
+ *
+ * @param fsmHandle - fsm instance
+ * @param region - initialized export region or NULL to detach the slot of the instance
+ * @param index - slot index (0 - nrOfSlots - 1)
+ * @return  0 - slot attached (or detached)
+ *         -1 - invalid region or slot index, FSM_EXPORT = 0
+ */
+int8_t fsmAttachExport(FsmHandle_t* fsmHandle, FsmExportRegion_t* region, const uint32_t index)
+{
+    int8_t exportAttached = -1;
+
+#if (FSM_EXPORT != 0)
+    if (NULL == region)
+    {
+        if (NULL != fsmHandle->exportSlot)
+        {
+            atomic_store_explicit(&fsmHandle->exportSlot->attached, 0, memory_order_relaxed);
+        }
+        fsmHandle->exportSlot = NULL;
+        exportAttached = 0;
+    }
+    else if ((FSM_EXPORT_MAGIC == region->magic) && (index < region->nrOfSlots))
+    {
+        FsmExportSlot_t* slot = &region->slots[index];
+        uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+        atomic_store_explicit(&slot->sequence, sequence + 1U, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        atomic_store_explicit(&slot->transitions, 0, memory_order_relaxed);
+        atomic_store_explicit(&slot->timestamp, FSM_EXPORT_TIMESTAMP(), memory_order_relaxed);
+        atomic_store_explicit(&slot->id, fsmHandle->id, memory_order_relaxed);
+        atomic_store_explicit(&slot->state, fsmHandle->currentState, memory_order_relaxed);
+        atomic_store_explicit(&slot->attached, 1, memory_order_relaxed);
+        atomic_store_explicit(&slot->sequence, sequence + 2U, memory_order_release);
+
+        fsmHandle->exportSlot = slot;
+        exportAttached = 0;
+    }
+#else
+    (void)fsmHandle;
+    (void)region;
+    (void)index;
+#endif
+    return exportAttached;
+}
+
+/**
+ * @brief Read a consistent copy of an export slot, e.g. from another
+ *        process that maps the region. The read is retried while the
+ *        instance writes the slot, the instance is never blocked.
+ *
+ * @param region - export region
+ * @param index - slot index (0 - nrOfSlots - 1)
+ * @param state - [out] state of the instance
+ * @return  0 - state read
+ *         -1 - invalid region or slot index, no instance attached or the
+ *              slot changed on every retry (FSM_EXPORT_READ_RETRIES)
+ */
+int8_t fsmExportRead(const FsmExportRegion_t* region, const uint32_t index, FsmExportState_t* state)
+{
+    int8_t stateRead = -1;
+
+    if ((FSM_EXPORT_MAGIC == region->magic) && (index < region->nrOfSlots))
+    {
+        FsmExportSlot_t* slot = (FsmExportSlot_t*)&region->slots[index];
+        uint8_t consistent = 0;
+        uint8_t attached = 0;
+
+        for (uint8_t retry = 0; (retry < FSM_EXPORT_READ_RETRIES) && (0 == consistent); retry++)
+        {
+            uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+            if (0 == (sequence & 1U))
+            {
+                state->transitions = atomic_load_explicit(&slot->transitions, memory_order_relaxed);
+                state->timestamp = atomic_load_explicit(&slot->timestamp, memory_order_relaxed);
+                state->id = atomic_load_explicit(&slot->id, memory_order_relaxed);
+                state->state = atomic_load_explicit(&slot->state, memory_order_relaxed);
+                attached = atomic_load_explicit(&slot->attached, memory_order_relaxed);
+                atomic_thread_fence(memory_order_acquire);
+
+                consistent = (sequence == atomic_load_explicit(&slot->sequence, memory_order_relaxed)) ? 1 : 0;
+            }
+        }
+
+        if ((0 != consistent) && (0 != attached))
+        {
+            stateRead = 0;
+        }
+    }
+    return stateRead;
+}
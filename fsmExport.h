@@ -0,0 +1,164 @@
+/********************************************************************************
+ * @file           : fsmExport.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Seqlock shared memory export of FSM instance states
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Optional state export, compiled in with FSM_EXPORT = 1 (default 0).
+ * Every instance with an export slot publishes its current state, the
+ * number of state changes and the timestamp of the last one into a region
+ * in shared memory (or a memory mapped file, or RAM that a debugger reads).
+ * External readers (e.g. a monitoring process) sample thousands of
+ * instances with plain loads, without any call into the firmware and
+ * without syscalls.
+ *
+ * Each slot is a seqlock with a single writer, the instance: on a
+ * transition fsmDispatch() makes the sequence odd, writes the slot and
+ * makes the sequence even again. No atomic read-modify-write and no lock
+ * is needed, so the writer is never blocked by readers. Readers retry
+ * while the sequence is odd or changed during the read
+ * (see fsmExportRead()). Calls without transition don't touch the slot.
+ *
+ * The timestamp is read with FSM_EXPORT_TIMESTAMP(), by default it calls
+ * fsmExportTimestamp(), which must be implemented by the application
+ * (e.g. return a tick counter or DWT->CYCCNT).
+ *
+ * Region layout (native endianness, slots are written as in memory):
+ *     header: uint32 magic FSM_EXPORT_MAGIC, uint16 version, uint16 slot size,
+ *             uint32 number of slots, uint32 reserved
+ *     slots:  FsmExportSlot_t
+ *
+ * Example usage:
+ *
+ *     int fd = shm_open("/protoFsm", O_CREAT | O_RDWR, 0644);
+ *     ftruncate(fd, FSM_EXPORT_REGION_SIZE(64));
+ *     FsmExportRegion_t* region = mmap(NULL, FSM_EXPORT_REGION_SIZE(64), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+ *
+ *     fsmExportInit(region, 64);
+ *     fsmAttachExport(&protoFsm, region, 0);
+ *
+ * Reader (other process, same mapping read only):
+ *
+ *     FsmExportState_t state;
+ *
+ *     if (0 == fsmExportRead(region, 0, &state))
+ *     {
+ *         printf("%u: state %u, %lu transitions\n", state.id, state.state, (unsigned long)state.transitions);
+ *     }
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_EXPORT_H
+#define FSM_EXPORT_H
+
+#include "stdint.h"
+#include "stddef.h"
+#ifndef __cplusplus
+#include "stdatomic.h"
+#endif
+#include "fsm.h"
+
+#define FSM_EXPORT_MAGIC    0x58455346UL /* "FSEX" */
+#define FSM_EXPORT_VERSION  (uint16_t)1U
+
+/* Max number of reads of a slot that a writer changed meanwhile, before fsmExportRead() gives up. */
+#ifndef FSM_EXPORT_READ_RETRIES
+#define FSM_EXPORT_READ_RETRIES  16U
+#endif
+
+#ifndef FSM_EXPORT_TIMESTAMP
+uint32_t fsmExportTimestamp(void);
+#define FSM_EXPORT_TIMESTAMP()  fsmExportTimestamp()
+#endif
+
+struct FsmExportSlot
+{
+    FSM_ATOMIC(uint32_t) sequence;    /* odd while the instance writes the slot */
+    FSM_ATOMIC(uint32_t) transitions; /* number of state changes */
+    FSM_ATOMIC(uint32_t) timestamp;   /* timestamp of the last state change */
+    FSM_ATOMIC(uint16_t) id;
+    FSM_ATOMIC(uint8_t) state;
+    FSM_ATOMIC(uint8_t) attached;     /* slot is used by an instance */
+};
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t slotSize;
+    uint32_t nrOfSlots;
+    uint32_t reserved;
+    FsmExportSlot_t slots[];
+} FsmExportRegion_t;
+
+/* Consistent copy of a slot, see fsmExportRead(). */
+typedef struct
+{
+    uint32_t transitions;
+    uint32_t timestamp;
+    uint16_t id;
+    uint8_t state;
+} FsmExportState_t;
+
+/* Bytes of a region with nrOfSlots slots. */
+#define FSM_EXPORT_REGION_SIZE(nrOfSlots)  (sizeof(FsmExportRegion_t) + ((size_t)(nrOfSlots) * sizeof(FsmExportSlot_t)))
+
+int8_t fsmExportInit(FsmExportRegion_t* region, const uint32_t nrOfSlots);
+int8_t fsmAttachExport(FsmHandle_t* fsmHandle, FsmExportRegion_t* region, const uint32_t index);
+int8_t fsmExportRead(const FsmExportRegion_t* region, const uint32_t index, FsmExportState_t* state);
+
+#ifndef __cplusplus
+/**
+ * @brief Publish the state of an instance to its export slot
+ *        (used by fsmDispatch() on transitions, not available in C++).
+ *
+ * @param slot - export slot of the instance
+ * @param id - instance id
+ * @param state - current state
+ */
+static inline void fsmExportWrite(FsmExportSlot_t* slot, const uint16_t id, const uint8_t state)
+{
+    if (NULL != slot)
+    {
+        /* only the instance writes the slot, so no read-modify-write is needed */
+        uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+        atomic_store_explicit(&slot->sequence, sequence + 1U, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        atomic_store_explicit(&slot->transitions, atomic_load_explicit(&slot->transitions, memory_order_relaxed) + 1U,
+                              memory_order_relaxed);
+        atomic_store_explicit(&slot->timestamp, FSM_EXPORT_TIMESTAMP(), memory_order_relaxed);
+        atomic_store_explicit(&slot->id, id, memory_order_relaxed);
+        atomic_store_explicit(&slot->state, state, memory_order_relaxed);
+        atomic_store_explicit(&slot->sequence, sequence + 2U, memory_order_release);
+    }
+}
+#endif
+
+#endif /* FSM_EXPORT_H */
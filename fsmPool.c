@@ -0,0 +1,185 @@
+/********************************************************************************
+ * @file           : fsmPool.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Fixed-block pool of FSM instances
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmPool.h"
+#include "stddef.h"
+
+/**
+ * @brief Initialize a pool, all blocks are free.
+ *
+ * @param pool - pool instance
+ * @param blocks - block array with nrOfBlocks items
+ * @param freeList - free list with nrOfBlocks items
+ * @param nrOfBlocks - number of blocks (1 - 65535)
+ * @return  0 - pool initialized
+ *         -1 - invalid arrays or number of blocks
+ */
+int8_t fsmPoolInit(FsmPool_t* pool, FsmPoolBlock_t* blocks, uint16_t* freeList, const uint16_t nrOfBlocks)
+{
+    int8_t poolInitialized = -1;
+
+    if ((NULL != blocks) && (NULL != freeList) && (nrOfBlocks > 0))
+    {
+        /* block 0 on top, so the blocks are handed out in address order first */
+        for (uint16_t i = 0; i < nrOfBlocks; i++)
+        {
+            freeList[i] = (uint16_t)(nrOfBlocks - 1U - i);
+            blocks[i].fsmHandle.def = NULL;
+        }
+        pool->blocks = blocks;
+        pool->freeList = freeList;
+        pool->slots = NULL;
+        pool->queueSize = 0;
+        pool->nrOfBlocks = nrOfBlocks;
+        pool->nrOfFree = nrOfBlocks;
+        pool->stats.inUse = 0;
+        pool->stats.highWater = 0;
+        pool->stats.failed = 0;
+        poolInitialized = 0;
+    }
+    return poolInitialized;
+}
+
+/**
+ * @brief Give every block of the pool an event queue, the queue is attached
+ *        to the instance on acquire. Must be called before the first acquire.
+ *
+ * @param pool - pool instance
+ * @param slots - queue slots with nrOfBlocks * queueSize items
+ * @param queueSize - number of slots per queue, power of two (2 - 32768)
+ * @return  0 - queues set
+ *         -1 - invalid slot array or queue size, FSM_QUEUE = 0
+ */
+int8_t fsmPoolSetQueues(FsmPool_t* pool, FsmQueueSlot_t* slots, const uint16_t queueSize)
+{
+    int8_t queuesSet = -1;
+
+#if (FSM_QUEUE != 0)
+    if ((NULL != slots) && (queueSize >= 2) && (0 == (queueSize & (queueSize - 1))))
+    {
+        pool->slots = slots;
+        pool->queueSize = queueSize;
+        queuesSet = 0;
+    }
+#else
+    (void)pool;
+    (void)slots;
+    (void)queueSize;
+#endif
+    return queuesSet;
+}
+
+/**
+ * @brief Take a block from the pool and initialize its instance
+ *        (see fsmInit()), the queue is empty and attached.
+ *
+ * @param pool - pool instance
+ * @param fsmDef - fsm definition used by the instance
+ * @param initState - state that should be started first
+ * @param context - user data of the instance (may be NULL)
+ * @return fsm instance, NULL if the pool is empty or initState is invalid
+ */
+FsmHandle_t* fsmPoolAcquire(FsmPool_t* pool, const FsmDef_t* fsmDef, const uint8_t initState, void* context)
+{
+    FsmHandle_t* fsmHandle = NULL;
+
+    if ((pool->nrOfFree > 0) && (initState < fsmDef->nrOfStates))
+    {
+        uint16_t index = pool->freeList[pool->nrOfFree - 1U];
+        FsmPoolBlock_t* block = &pool->blocks[index];
+
+        pool->nrOfFree--;
+        fsmHandle = &block->fsmHandle;
+        (void)fsmInit(fsmHandle, fsmDef, initState, context);
+
+#if (FSM_QUEUE != 0)
+        if (NULL != pool->slots)
+        {
+            (void)fsmQueueInit(&block->queue, &pool->slots[(uint32_t)index * pool->queueSize], pool->queueSize);
+            fsmAttachQueue(fsmHandle, &block->queue);
+        }
+#endif
+
+        pool->stats.inUse++;
+        if (pool->stats.inUse > pool->stats.highWater)
+        {
+            pool->stats.highWater = pool->stats.inUse;
+        }
+    }
+    else if (0 == pool->nrOfFree)
+    {
+        pool->stats.failed++;
+    }
+    return fsmHandle;
+}
+
+/**
+ * @brief Give a block back to the pool. The instance must not be used
+ *        afterwards (detach it from schedulers, stop its timer first).
+ *
+ * @param pool - pool instance
+ * @param fsmHandle - fsm instance returned by fsmPoolAcquire()
+ * @return  0 - block released
+ *         -1 - instance is not from this pool or already released
+ */
+int8_t fsmPoolRelease(FsmPool_t* pool, FsmHandle_t* fsmHandle)
+{
+    int8_t blockReleased = -1;
+    /* the handle is the first member of its block */
+    FsmPoolBlock_t* block = (FsmPoolBlock_t*)fsmHandle;
+
+    if ((block >= pool->blocks) && (block < &pool->blocks[pool->nrOfBlocks]) &&
+        (NULL != fsmHandle->def) && (pool->nrOfFree < pool->nrOfBlocks))
+    {
+        uint16_t index = (uint16_t)(block - pool->blocks);
+
+        if (&pool->blocks[index].fsmHandle == fsmHandle)
+        {
+            fsmHandle->def = NULL;
+            pool->freeList[pool->nrOfFree] = index;
+            pool->nrOfFree++;
+            pool->stats.inUse--;
+            blockReleased = 0;
+        }
+    }
+    return blockReleased;
+}
+
+/**
+ * @brief Get the statistics of a pool.
+ *
+ * @param pool - pool instance
+ * @param stats - [out] statistics
+ */
+void fsmPoolGetStats(const FsmPool_t* pool, FsmPoolStats_t* stats)
+{
+    *stats = pool->stats;
+}
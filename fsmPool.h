@@ -0,0 +1,108 @@
+/********************************************************************************
+ * @file           : fsmPool.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Fixed-block pool of FSM instances
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Fixed-block pool of fsm instances (handle plus optional event queue,
+ * FSM_QUEUE = 1) for instances that are created and destroyed at runtime,
+ * e.g. one fsm per connection. Memory is sized for the pool instead of the
+ * worst case of every user, and there is still no dynamic memory
+ * allocation: the blocks are arrays provided by the user.
+ *
+ * fsmPoolAcquire() and fsmPoolRelease() are O(1). Free blocks are kept on
+ * a LIFO stack, so the most recently released block (still in the cache)
+ * is handed out first. The pool counts the blocks in use, the high-water
+ * mark and the failed acquires to size the pool in the field.
+ *
+ * The pool is not thread safe, acquire and release have to be called from
+ * one context (e.g. the thread that accepts and closes connections).
+ *
+ * Example usage:
+ *
+ *     static FsmPoolBlock_t connPoolBlocks[MAX_NR_OF_CONNECTIONS];
+ *     static uint16_t connPoolFreeList[MAX_NR_OF_CONNECTIONS];
+ *     static FsmQueueSlot_t connPoolSlots[MAX_NR_OF_CONNECTIONS * 16];
+ *     static FsmPool_t connPool;
+ *
+ *     fsmPoolInit(&connPool, connPoolBlocks, connPoolFreeList, MAX_NR_OF_CONNECTIONS);
+ *     fsmPoolSetQueues(&connPool, connPoolSlots, 16);
+ *
+ *     void onAccept(Connection_t* conn)
+ *     {
+ *         conn->fsm = fsmPoolAcquire(&connPool, &connFsmDef, CONN_STATE_IDLE, conn);
+ *     }
+ *
+ *     void onClose(Connection_t* conn)
+ *     {
+ *         fsmPoolRelease(&connPool, conn->fsm);
+ *     }
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_POOL_H
+#define FSM_POOL_H
+
+#include "stdint.h"
+#include "fsm.h"
+#include "fsmQueue.h"
+
+typedef struct
+{
+    FsmHandle_t fsmHandle; /* must be the first member, see fsmPoolRelease() */
+#if (FSM_QUEUE != 0)
+    FsmQueue_t queue;
+#endif
+} FsmPoolBlock_t;
+
+typedef struct
+{
+    uint16_t inUse;     /* blocks in use */
+    uint16_t highWater; /* max blocks in use since init */
+    uint32_t failed;    /* acquires that failed because the pool was empty */
+} FsmPoolStats_t;
+
+typedef struct
+{
+    FsmPoolBlock_t* blocks;
+    uint16_t* freeList;    /* stack of free block indices, top is freeList[nrOfFree - 1] */
+    FsmQueueSlot_t* slots; /* queue slots of all blocks, NULL if the blocks have no queue */
+    uint16_t queueSize;
+    uint16_t nrOfBlocks;
+    uint16_t nrOfFree;
+    FsmPoolStats_t stats;
+} FsmPool_t;
+
+int8_t fsmPoolInit(FsmPool_t* pool, FsmPoolBlock_t* blocks, uint16_t* freeList, const uint16_t nrOfBlocks);
+int8_t fsmPoolSetQueues(FsmPool_t* pool, FsmQueueSlot_t* slots, const uint16_t queueSize);
+FsmHandle_t* fsmPoolAcquire(FsmPool_t* pool, const FsmDef_t* fsmDef, const uint8_t initState, void* context);
+int8_t fsmPoolRelease(FsmPool_t* pool, FsmHandle_t* fsmHandle);
+void fsmPoolGetStats(const FsmPool_t* pool, FsmPoolStats_t* stats);
+
+#endif /* FSM_POOL_H */
@@ -0,0 +1,198 @@
+/********************************************************************************
+ * @file           : fsmProfile.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Cycle profiling of FSM states and transitions
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmProfile.h"
+
+/**
+ * @brief Initialize a profile and clear all statistics.
+ *
+ * @param profile - profile instance
+ * @param states - state statistics with nrOfStates items
+ * @param transitions - transition statistics with nrOfStates * nrOfStates
+ *                      items, NULL if transitions are not recorded
+ * @param nrOfStates - number of states of the fsm definition
+ * @return  0 - profile initialized
+ *         -1 - invalid state statistics or number of states
+ */
+int8_t fsmProfileInit(FsmProfile_t* profile, FsmStateProfile_t* states, FsmTransitionProfile_t* transitions, const uint8_t nrOfStates)
+{
+    int8_t profileInitialized = -1;
+
+    profile->states = states;
+    profile->transitions = transitions;
+    profile->histograms = NULL;
+    profile->overrunFunc = NULL;
+    profile->overrunArg = NULL;
+    profile->nrOfStates = 0;
+
+    if ((NULL != states) && (nrOfStates > 0))
+    {
+        profile->nrOfStates = nrOfStates;
+        fsmProfileReset(profile);
+        profileInitialized = 0;
+    }
+    return profileInitialized;
+}
+
+/**
+ * @brief Clear all statistics of a profile.
+ *
+ * @param profile - profile instance
+ */
+void fsmProfileReset(FsmProfile_t* profile)
+{
+    for (uint8_t i = 0; i < profile->nrOfStates; i++)
+    {
+        profile->states[i].calls = 0;
+        profile->states[i].maxCycles = 0;
+        profile->states[i].cycles = 0;
+        profile->states[i].overruns = 0;
+
+        if (NULL != profile->histograms)
+        {
+            for (uint8_t bucket = 0; bucket < FSM_PROFILE_NR_OF_BUCKETS; bucket++)
+            {
+                profile->histograms[i].buckets[bucket] = 0;
+            }
+        }
+    }
+
+    if (NULL != profile->transitions)
+    {
+        for (uint16_t i = 0; i < ((uint16_t)profile->nrOfStates * profile->nrOfStates); i++)
+        {
+            profile->transitions[i].count = 0;
+            profile->transitions[i].maxCycles = 0;
+            profile->transitions[i].cycles = 0;
+        }
+    }
+}
+
+/**
+ * @brief Copy the statistics of a profile. Must be called from the context
+ *        that runs the fsm instances using the profile, otherwise the copy
+ *        may contain partly updated entries.
+ *
+ * @param profile - profile instance
+ * @param states - [out] state statistics with nrOfStates items
+ * @param transitions - [out] transition statistics with nrOfStates * nrOfStates
+ *                      items, NULL if not needed
+ */
+void fsmProfileSnapshot(const FsmProfile_t* profile, FsmStateProfile_t* states, FsmTransitionProfile_t* transitions)
+{
+    for (uint8_t i = 0; i < profile->nrOfStates; i++)
+    {
+        states[i] = profile->states[i];
+    }
+
+    if ((NULL != transitions) && (NULL != profile->transitions))
+    {
+        for (uint16_t i = 0; i < ((uint16_t)profile->nrOfStates * profile->nrOfStates); i++)
+        {
+            transitions[i] = profile->transitions[i];
+        }
+    }
+}
+
+/**
+ * @brief Record a log2 histogram of the state function cycles per state.
+ *        The histograms are cleared.
+ *
+ * @param profile - profile instance, initialized with fsmProfileInit()
+ * @param histograms - histograms with nrOfStates items, NULL to stop recording
+ */
+void fsmProfileSetHistograms(FsmProfile_t* profile, FsmProfileHistogram_t* histograms)
+{
+    profile->histograms = histograms;
+
+    for (uint8_t i = 0; (NULL != histograms) && (i < profile->nrOfStates); i++)
+    {
+        for (uint8_t bucket = 0; bucket < FSM_PROFILE_NR_OF_BUCKETS; bucket++)
+        {
+            histograms[i].buckets[bucket] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Copy the histogram of a state. Must be called from the context
+ *        that runs the fsm instances using the profile.
+ *
+ * @param profile - profile instance
+ * @param state - state index
+ * @param histogram - [out] histogram of the state
+ * @return  0 - histogram copied
+ *         -1 - no histograms recorded or invalid state
+ */
+int8_t fsmProfileGetHistogram(const FsmProfile_t* profile, const uint8_t state, FsmProfileHistogram_t* histogram)
+{
+    int8_t histogramCopied = -1;
+
+    if ((NULL != profile->histograms) && (state < profile->nrOfStates))
+    {
+        *histogram = profile->histograms[state];
+        histogramCopied = 0;
+    }
+    return histogramCopied;
+}
+
+/**
+ * @brief Set the function that is called if a state function took longer
+ *        than the budget of its state. It is called from fsmDispatch()
+ *        right after the state function.
+ *
+ * @param profile - profile instance
+ * @param overrunFunc - overrun function, NULL for none (overruns are counted anyway)
+ * @param overrunArg - argument passed to the overrun function
+ */
+void fsmProfileSetOverrunFunc(FsmProfile_t* profile, FsmOverrunFunc_t* overrunFunc, void* overrunArg)
+{
+    profile->overrunFunc = overrunFunc;
+    profile->overrunArg = overrunArg;
+}
+
+/**
+ * @brief Attach a profile to a fsm instance. Several instances of the same
+ *        definition may share one profile to get accumulated statistics.
+ *        Without FSM_PROFILING the call has no effect.
+ *
+ * @param fsmHandle - fsm instance
+ * @param profile - profile instance or NULL to stop recording
+ */
+void fsmAttachProfile(FsmHandle_t* fsmHandle, FsmProfile_t* profile)
+{
+#if (FSM_PROFILING != 0)
+    fsmHandle->profile = profile;
+#else
+    (void)fsmHandle;
+    (void)profile;
+#endif
+}
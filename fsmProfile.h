@@ -0,0 +1,251 @@
+/********************************************************************************
+ * @file           : fsmProfile.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Cycle profiling of FSM states and transitions
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Optional instrumentation of fsmDispatch() / fsmRun(), compiled in with
+ * FSM_PROFILING = 1 (default 0, no code and no handle field is added).
+ *
+ * Per state the number of calls and the cumulative and max cycles spent to
+ * find the next state (state function or transition table) are recorded.
+ * Per transition (from, to) the number of transitions and the cumulative
+ * and max cycles of exit function, action and entry function are recorded.
+ * All statistics are stored in user provided arrays, no memory is allocated.
+ *
+ * States can have a cycle budget for the state function (FSM_STATE_BUDGET()
+ * in the state table entry or fsmDefSetBudget()). Executions that take
+ * longer are counted as overruns of the state and reported to the overrun
+ * function of the profile, e.g. to log the state or to switch to a safe
+ * mode. The state function is not interrupted, the budget is checked after
+ * it returned. The budget only exists with FSM_PROFILING.
+ * Optionally a log2 histogram of the cycles is kept per state
+ * (bucket b counts executions of 2^(b - 1) - 2^b - 1 cycles, bucket 0 of
+ * 0 cycles), which shows how often a state gets close to its budget.
+ *
+ * The cycle counter is read with FSM_PROFILE_CYCLES(). By default it calls
+ * fsmProfileCycles(), which must be implemented by the application, e.g.
+ *
+ *     uint32_t fsmProfileCycles(void)
+ *     {
+ *         return DWT->CYCCNT;         // Cortex-M3/M4/M7, enable DWT first
+ *     }
+ *
+ *     uint32_t fsmProfileCycles(void)
+ *     {
+ *         return (uint32_t)__rdtsc(); // x86
+ *     }
+ *
+ * or FSM_PROFILE_CYCLES() is defined as a macro to read the counter inline.
+ *
+ * Example usage:
+ *
+ *     static FsmStateProfile_t protoStateProfile[PROTO_NR_OF_STATES];
+ *     static FsmTransitionProfile_t protoTransitionProfile[PROTO_NR_OF_STATES * PROTO_NR_OF_STATES];
+ *     static FsmProfile_t protoProfile;
+ *
+ *     fsmProfileInit(&protoProfile, protoStateProfile, protoTransitionProfile, PROTO_NR_OF_STATES);
+ *     fsmAttachProfile(&protoFsm, &protoProfile);
+ *
+ *     ...
+ *
+ *     fsmProfileSnapshot(&protoProfile, stateCopy, transitionCopy);
+ *     // stateCopy[s].maxCycles shows the state that blows the deadline
+ *
+ * Budgets, overrun function and histograms:
+ *
+ *     static const FsmStateDef_t protoFsmTable[] =
+ *     {
+ *         [PROTO_STATE_IDLE]    = { StateIdle,    NULL, NULL, 0 },
+ *         [PROTO_STATE_CONTROL] = { StateControl, NULL, NULL, 0, FSM_STATE_BUDGET(2000U) },
+ *     };
+ *
+ *     static void OnOverrun(void* overrunArg, const uint16_t id, const uint8_t state, const uint32_t cycles)
+ *     {
+ *         logOverrun(id, state, cycles);
+ *     }
+ *
+ *     static FsmProfileHistogram_t protoHistograms[PROTO_NR_OF_STATES];
+ *
+ *     fsmProfileSetHistograms(&protoProfile, protoHistograms);
+ *     fsmProfileSetOverrunFunc(&protoProfile, OnOverrun, NULL);
+ *
+ ********************************************************************************/
+
+#ifndef FSM_PROFILE_H
+#define FSM_PROFILE_H
+
+#include "stdint.h"
+#include "stddef.h"
+#include "fsm.h"
+
+#ifndef FSM_PROFILE_CYCLES
+uint32_t fsmProfileCycles(void);
+#define FSM_PROFILE_CYCLES()  fsmProfileCycles()
+#endif
+
+/* Number of log2 buckets of a state histogram, the last bucket also counts all longer executions. */
+#ifndef FSM_PROFILE_NR_OF_BUCKETS
+#define FSM_PROFILE_NR_OF_BUCKETS  32U
+#endif
+
+/* Called if a state function took longer than the budget of the state. */
+typedef void FsmOverrunFunc_t(void* overrunArg, const uint16_t id, const uint8_t state, const uint32_t cycles);
+
+typedef struct
+{
+    uint32_t calls;
+    uint32_t maxCycles;
+    uint64_t cycles;
+    uint32_t overruns; /* executions longer than the budget of the state */
+} FsmStateProfile_t;
+
+typedef struct
+{
+    uint32_t buckets[FSM_PROFILE_NR_OF_BUCKETS];
+} FsmProfileHistogram_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t maxCycles;
+    uint64_t cycles;
+} FsmTransitionProfile_t;
+
+struct FsmProfile
+{
+    FsmStateProfile_t* states;           /* nrOfStates items */
+    FsmTransitionProfile_t* transitions; /* nrOfStates * nrOfStates items, index from * nrOfStates + to, may be NULL */
+    FsmProfileHistogram_t* histograms;   /* nrOfStates items, may be NULL */
+    FsmOverrunFunc_t* overrunFunc;       /* may be NULL */
+    void* overrunArg;
+    uint8_t nrOfStates;
+};
+
+int8_t fsmProfileInit(FsmProfile_t* profile, FsmStateProfile_t* states, FsmTransitionProfile_t* transitions, const uint8_t nrOfStates);
+void fsmProfileReset(FsmProfile_t* profile);
+void fsmProfileSnapshot(const FsmProfile_t* profile, FsmStateProfile_t* states, FsmTransitionProfile_t* transitions);
+void fsmProfileSetHistograms(FsmProfile_t* profile, FsmProfileHistogram_t* histograms);
+int8_t fsmProfileGetHistogram(const FsmProfile_t* profile, const uint8_t state, FsmProfileHistogram_t* histogram);
+void fsmProfileSetOverrunFunc(FsmProfile_t* profile, FsmOverrunFunc_t* overrunFunc, void* overrunArg);
+void fsmAttachProfile(FsmHandle_t* fsmHandle, FsmProfile_t* profile);
+
+/**
+ * @brief Get the histogram bucket of a number of cycles (bit length).
+ *
+ * @param cycles - cycles of an execution
+ * @return bucket index (0 - FSM_PROFILE_NR_OF_BUCKETS - 1)
+ */
+static inline uint8_t fsmProfileBucket(uint32_t cycles)
+{
+    uint8_t bucket = 0;
+
+#if defined(__GNUC__) || defined(__clang__)
+    if (0 != cycles)
+    {
+        bucket = (uint8_t)(32U - (uint8_t)__builtin_clz(cycles));
+    }
+#else
+    while (0 != cycles)
+    {
+        cycles >>= 1;
+        bucket++;
+    }
+#endif
+    return (bucket < FSM_PROFILE_NR_OF_BUCKETS) ? bucket : (uint8_t)(FSM_PROFILE_NR_OF_BUCKETS - 1U);
+}
+
+#if (FSM_PROFILING != 0)
+/**
+ * @brief Record the execution of a state and check its budget (used by fsmDispatch()).
+ *
+ * @param profile - profile of the instance, may be NULL
+ * @param fsmHandle - fsm instance (budget of the state and id for the overrun function)
+ * @param state - executed state
+ * @param start - cycle counter before the state was executed
+ */
+static inline void fsmProfileState(FsmProfile_t* profile, const FsmHandle_t* fsmHandle, const uint8_t state, const uint32_t start)
+{
+    uint32_t cycles = FSM_PROFILE_CYCLES() - start;
+
+    if ((NULL != profile) && (state < profile->nrOfStates))
+    {
+        FsmStateProfile_t* stateProfile = &profile->states[state];
+        uint32_t budget = fsmHandle->def->table[state].budget;
+
+        stateProfile->calls++;
+        stateProfile->cycles += cycles;
+        if (cycles > stateProfile->maxCycles)
+        {
+            stateProfile->maxCycles = cycles;
+        }
+
+        if (NULL != profile->histograms)
+        {
+            profile->histograms[state].buckets[fsmProfileBucket(cycles)]++;
+        }
+
+        if ((0 != budget) && (cycles > budget))
+        {
+            stateProfile->overruns++;
+            if (NULL != profile->overrunFunc)
+            {
+                profile->overrunFunc(profile->overrunArg, fsmHandle->id, state, cycles);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Record a transition (used by fsmDispatch()).
+ *
+ * @param profile - profile of the instance, may be NULL
+ * @param state - state that was left
+ * @param stateNext - state that was entered
+ * @param start - cycle counter before the exit function was called
+ */
+static inline void fsmProfileTransition(FsmProfile_t* profile, const uint8_t state, const uint8_t stateNext, const uint32_t start)
+{
+    uint32_t cycles = FSM_PROFILE_CYCLES() - start;
+
+    if ((NULL != profile) && (NULL != profile->transitions) &&
+        (state < profile->nrOfStates) && (stateNext < profile->nrOfStates))
+    {
+        FsmTransitionProfile_t* transitionProfile = &profile->transitions[(uint16_t)state * profile->nrOfStates + stateNext];
+
+        transitionProfile->count++;
+        transitionProfile->cycles += cycles;
+        if (cycles > transitionProfile->maxCycles)
+        {
+            transitionProfile->maxCycles = cycles;
+        }
+    }
+}
+#endif
+
+#endif /* FSM_PROFILE_H */
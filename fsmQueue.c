@@ -0,0 +1,301 @@
+/********************************************************************************
+ * @file           : fsmQueue.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Lock-free event queue for FSM instances
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmQueue.h"
+#include "stddef.h"
+
+/*
+ * Bounded queue with a sequence number per slot (D. Vyukov).
+ * A slot is free for position pos if its sequence equals pos and holds
+ * an event for position pos if its sequence equals pos + 1. Producers
+ * reserve a position by advancing head and publish the event by
+ * releasing the slot sequence, so the consumer never sees a slot that
+ * is only half written. The consumer owns tail exclusively.
+ */
+
+/**
+ * @brief Initialize an event queue.
+ *
+ * @param queue - queue instance
+ * @param slots - slot array with size items
+ * @param size - number of slots, power of two (2 - 32768)
+ * @return  0 - queue initialized
+ *         -1 - invalid slot array or size
+ */
+int8_t fsmQueueInit(FsmQueue_t* queue, FsmQueueSlot_t* slots, const uint16_t size)
+{
+    int8_t queueInitialized = -1;
+
+    if ((NULL != slots) && (size >= 2) && (0 == (size & (size - 1))))
+    {
+        for (uint16_t i = 0; i < size; i++)
+        {
+            atomic_init(&slots[i].sequence, i);
+            slots[i].event = FSM_EVENT_TICK;
+        }
+        queue->slots = slots;
+        queue->mask = (uint32_t)size - 1;
+        atomic_init(&queue->head, 0);
+        queue->tail = 0;
+        queueInitialized = 0;
+    }
+    return queueInitialized;
+}
+
+/**
+ * @brief Post an event to the queue. Must only be used if the queue has a
+ *        single producer. Can be called from interrupt context.
+ *
+ * @param queue - queue instance
+ * @param event - event to post
+ * @return  0 - event posted
+ *         -1 - queue is full
+ */
+int8_t fsmQueuePost(FsmQueue_t* queue, const FsmEvent_t event)
+{
+    int8_t eventPosted = -1;
+    uint32_t pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    FsmQueueSlot_t* slot = &queue->slots[pos & queue->mask];
+
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) == pos)
+    {
+        atomic_store_explicit(&queue->head, pos + 1, memory_order_relaxed);
+        slot->event = event;
+        atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+        eventPosted = 0;
+    }
+    return eventPosted;
+}
+
+/**
+ * @brief Post an event to the queue. Safe for any number of producers
+ *        (interrupts of different priorities, threads).
+ *
+ * @param queue - queue instance
+ * @param event - event to post
+ * @return  0 - event posted
+ *         -1 - queue is full
+ */
+int8_t fsmQueuePostMulti(FsmQueue_t* queue, const FsmEvent_t event)
+{
+    int8_t eventPosted = -1;
+    uint32_t pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    while (1)
+    {
+        FsmQueueSlot_t* slot = &queue->slots[pos & queue->mask];
+        int32_t diff = (int32_t)(atomic_load_explicit(&slot->sequence, memory_order_acquire) - pos);
+
+        if (0 == diff)
+        {
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                slot->event = event;
+                atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+                eventPosted = 0;
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            break; /* queue full */
+        }
+        else
+        {
+            pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }
+    }
+    return eventPosted;
+}
+
+/**
+ * @brief Take the oldest event from the queue. Must only be called by the
+ *        consumer of the queue.
+ *
+ * @param queue - queue instance
+ * @param event - [out] oldest event
+ * @return  0 - event read
+ *         -1 - queue is empty
+ */
+int8_t fsmQueueGet(FsmQueue_t* queue, FsmEvent_t* event)
+{
+    int8_t eventRead = -1;
+    uint32_t pos = queue->tail;
+    FsmQueueSlot_t* slot = &queue->slots[pos & queue->mask];
+
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) == (pos + 1))
+    {
+        *event = slot->event;
+        atomic_store_explicit(&slot->sequence, pos + queue->mask + 1, memory_order_release);
+        queue->tail = pos + 1;
+        eventRead = 0;
+    }
+    return eventRead;
+}
+
+/**
+ * @brief Check if the queue holds no event. Only reliable for the consumer,
+ *        a producer may post an event right after the check.
+ *
+ * @param queue - queue instance
+ * @return 1 - queue is empty
+ *         0 - at least one event is pending
+ */
+uint8_t fsmQueueIsEmpty(FsmQueue_t* queue)
+{
+    const FsmQueueSlot_t* slot = &queue->slots[queue->tail & queue->mask];
+
+    return (atomic_load_explicit(&slot->sequence, memory_order_acquire) != (queue->tail + 1)) ? 1 : 0;
+}
+
+/**
+ * @brief Attach an initialized event queue to a fsm instance.
+ *        Every instance needs its own queue.
+ *        Without FSM_QUEUE the call has no effect.
+ *
+ * @param fsmHandle - fsm instance
+ * @param queue - queue instance or NULL to detach the queue
+ */
+void fsmAttachQueue(FsmHandle_t* fsmHandle, FsmQueue_t* queue)
+{
+#if (FSM_QUEUE != 0)
+    fsmHandle->queue = queue;
+#else
+    (void)fsmHandle;
+    (void)queue;
+#endif
+}
+
+#if (FSM_QUEUE != 0)
+/**
+ * @brief Call the notify hook of an instance after an event was posted.
+ *
+ * @param fsmHandle - fsm instance
+ */
+static void fsmNotify(FsmHandle_t* fsmHandle)
+{
+    if (NULL != fsmHandle->notifyFunc)
+    {
+        fsmHandle->notifyFunc(fsmHandle->notifyArg, fsmHandle->id);
+    }
+}
+#endif
+
+/**
+ * @brief Post an event to the queue of a fsm instance (single producer).
+ *        The notify hook of the instance (e.g. scheduler) is called
+ *        after the event was posted.
+ *
+ * @param fsmHandle - fsm instance
+ * @param event - event to post
+ * @return  0 - event posted
+ *         -1 - no queue attached or queue is full, FSM_QUEUE = 0
+ */
+int8_t fsmPost(FsmHandle_t* fsmHandle, const FsmEvent_t event)
+{
+    int8_t eventPosted = -1;
+
+#if (FSM_QUEUE != 0)
+    if (NULL != fsmHandle->queue)
+    {
+        eventPosted = fsmQueuePost(fsmHandle->queue, event);
+        if (0 == eventPosted)
+        {
+            fsmNotify(fsmHandle);
+        }
+    }
+#else
+    (void)fsmHandle;
+    (void)event;
+#endif
+    return eventPosted;
+}
+
+/**
+ * @brief Post an event to the queue of a fsm instance (multiple producers).
+ *        The notify hook of the instance (e.g. scheduler) is called
+ *        after the event was posted.
+ *
+ * @param fsmHandle - fsm instance
+ * @param event - event to post
+ * @return  0 - event posted
+ *         -1 - no queue attached or queue is full, FSM_QUEUE = 0
+ */
+int8_t fsmPostMulti(FsmHandle_t* fsmHandle, const FsmEvent_t event)
+{
+    int8_t eventPosted = -1;
+
+#if (FSM_QUEUE != 0)
+    if (NULL != fsmHandle->queue)
+    {
+        eventPosted = fsmQueuePostMulti(fsmHandle->queue, event);
+        if (0 == eventPosted)
+        {
+            fsmNotify(fsmHandle);
+        }
+    }
+#else
+    (void)fsmHandle;
+    (void)event;
+#endif
+    return eventPosted;
+}
+
+/**
+ * @brief Dispatch the pending events of the instance queue to the fsm.
+ *        At most one queue length of events is processed per call, so a
+ *        producer that keeps posting can not starve the caller.
+ *
+ * @param fsmHandle - fsm instance
+ * @return number of dispatched events (0 without FSM_QUEUE)
+ */
+uint16_t fsmProcess(FsmHandle_t* fsmHandle)
+{
+    uint16_t nrOfEvents = 0;
+
+#if (FSM_QUEUE != 0)
+    if (NULL != fsmHandle->queue)
+    {
+        uint32_t maxEvents = fsmHandle->queue->mask + 1;
+        FsmEvent_t event;
+
+        while ((nrOfEvents < maxEvents) && (0 == fsmQueueGet(fsmHandle->queue, &event)))
+        {
+            fsmDispatch(fsmHandle, event);
+            nrOfEvents++;
+        }
+    }
+#else
+    (void)fsmHandle;
+#endif
+    return nrOfEvents;
+}
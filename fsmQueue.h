@@ -0,0 +1,109 @@
+/********************************************************************************
+ * @file           : fsmQueue.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Lock-free event queue for FSM instances
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Fixed-capacity ring buffer of events that can be attached to a FSM
+ * instance. Events are posted from interrupt handlers or other threads
+ * without disabling interrupts or taking a mutex, and fsmProcess()
+ * drains the queue through fsmDispatch() in the context of the FSM.
+ *
+ * The slot array is provided by the user, its size must be a power of
+ * two (2 - 32768). No dynamic memory allocation is used.
+ *
+ * The queue member of the instance, fsmAttachQueue(), fsmPost(),
+ * fsmPostMulti() and fsmProcess() are compiled in with FSM_QUEUE = 1
+ * (default 0). The queue functions themselves (fsmQueue*()) are always
+ * available.
+ *
+ * fsmPost() / fsmQueuePost() may only be used if there is exactly one
+ * producer for the queue (e.g. one ISR, or one thread).
+ * If several contexts post to the same queue (several ISRs with different
+ * priorities, ISR and main loop, several threads), all of them have to use
+ * fsmPostMulti() / fsmQueuePostMulti() which needs a compare-and-swap
+ * instruction (not available on Cortex-M0).
+ * There must be only one consumer (the context that runs the FSM).
+ *
+ * Example usage:
+ *
+ *     static FsmQueueSlot_t buttonFsmSlots[8];
+ *     static FsmQueue_t buttonFsmQueue;
+ *
+ *     fsmQueueInit(&buttonFsmQueue, buttonFsmSlots, 8);
+ *     fsmInit(&buttonFsm, &buttonFsmDef, FSM_STATE_INIT, NULL);
+ *     fsmAttachQueue(&buttonFsm, &buttonFsmQueue);
+ *
+ *     void EXTI0_IRQHandler(void)
+ *     {
+ *         fsmPost(&buttonFsm, EVENT_BUTTON_PRESSED);
+ *     }
+ *
+ *     while (1)
+ *     {
+ *         fsmProcess(&buttonFsm);
+ *         sleepUntilInterrupt();
+ *     }
+ *
+ ********************************************************************************/
+
+#ifndef FSM_QUEUE_H
+#define FSM_QUEUE_H
+
+#include "stdint.h"
+#ifndef __cplusplus
+#include "stdatomic.h"
+#endif
+#include "fsm.h"
+
+typedef struct
+{
+    FSM_ATOMIC(uint32_t) sequence;
+    FsmEvent_t event;
+} FsmQueueSlot_t;
+
+struct FsmQueue
+{
+    FsmQueueSlot_t* slots;
+    uint32_t mask;
+    FSM_ATOMIC(uint32_t) head;
+    uint32_t tail;
+};
+
+int8_t fsmQueueInit(FsmQueue_t* queue, FsmQueueSlot_t* slots, const uint16_t size);
+int8_t fsmQueuePost(FsmQueue_t* queue, const FsmEvent_t event);
+int8_t fsmQueuePostMulti(FsmQueue_t* queue, const FsmEvent_t event);
+int8_t fsmQueueGet(FsmQueue_t* queue, FsmEvent_t* event);
+uint8_t fsmQueueIsEmpty(FsmQueue_t* queue);
+
+void fsmAttachQueue(FsmHandle_t* fsmHandle, FsmQueue_t* queue);
+int8_t fsmPost(FsmHandle_t* fsmHandle, const FsmEvent_t event);
+int8_t fsmPostMulti(FsmHandle_t* fsmHandle, const FsmEvent_t event);
+uint16_t fsmProcess(FsmHandle_t* fsmHandle);
+
+#endif /* FSM_QUEUE_H */
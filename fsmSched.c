@@ -0,0 +1,257 @@
+/********************************************************************************
+ * @file           : fsmSched.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Cooperative scheduler for FSM instances
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmSched.h"
+#include "fsmQueue.h"
+#include "stddef.h"
+
+/*
+ * Instance id i is bit (31 - (i % 32)) of group (i / 32), group g is bit
+ * (31 - g) of the summary word. This way count leading zeros directly
+ * returns the lowest id (highest priority) that is ready.
+ */
+
+/**
+ * @brief Count leading zeros of a non zero 32 bit value.
+ *
+ * @param value - value to check, must not be 0
+ * @return number of leading zero bits (0 - 31)
+ */
+static inline uint8_t fsmSchedClz(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint8_t)__builtin_clz(value);
+#else
+    uint8_t zeros = 0;
+
+    while (0 == (value & 0x80000000U))
+    {
+        value <<= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+#if (FSM_QUEUE != 0)
+/**
+ * @brief Notify hook of the instances, marks the instance ready.
+ *
+ * @param notifyArg - scheduler instance
+ * @param id - scheduler id of the fsm instance
+ */
+static void fsmSchedNotify(void* notifyArg, const uint16_t id)
+{
+    fsmSchedSetReady((FsmSched_t*)notifyArg, id);
+}
+#endif
+
+/**
+ * @brief Initialize a scheduler.
+ *
+ * @param sched - scheduler instance
+ * @param handles - handle array with maxNrOfFsms items
+ * @param groups - ready bitmap with FSM_SCHED_NR_OF_GROUPS(maxNrOfFsms) items
+ * @param maxNrOfFsms - max number of fsm instances (1 - FSM_SCHED_MAX_NR_OF_FSMS)
+ * @return  0 - scheduler initialized
+ *         -1 - invalid arrays or number of instances
+ */
+int8_t fsmSchedInit(FsmSched_t* sched, FsmHandle_t** handles, FsmSchedGroup_t* groups, const uint16_t maxNrOfFsms)
+{
+    int8_t schedInitialized = -1;
+
+    if ((NULL != handles) && (NULL != groups) && (maxNrOfFsms > 0) && (maxNrOfFsms <= FSM_SCHED_MAX_NR_OF_FSMS))
+    {
+        for (uint16_t i = 0; i < FSM_SCHED_NR_OF_GROUPS(maxNrOfFsms); i++)
+        {
+            atomic_init(&groups[i], 0);
+        }
+        sched->handles = handles;
+        sched->groups = groups;
+        atomic_init(&sched->summary, 0);
+        sched->nrOfFsms = 0;
+        sched->maxNrOfFsms = maxNrOfFsms;
+        schedInitialized = 0;
+    }
+    return schedInitialized;
+}
+
+/**
+ * @brief Add a fsm instance to the scheduler. The instance gets the next
+ *        free scheduler id, which is also its priority (0 = highest).
+ *        Events posted to the instance queue mark it ready.
+ *        Should be called after fsmInit() and fsmAttachQueue().
+ *
+ * @param sched - scheduler instance
+ * @param fsmHandle - fsm instance
+ * @return >= 0 - scheduler id of the instance
+ *           -1 - scheduler is full
+ */
+int16_t fsmSchedAdd(FsmSched_t* sched, FsmHandle_t* fsmHandle)
+{
+    int16_t id = -1;
+
+    if (sched->nrOfFsms < sched->maxNrOfFsms)
+    {
+        id = (int16_t)sched->nrOfFsms;
+        sched->handles[id] = fsmHandle;
+        fsmHandle->id = (uint16_t)id;
+#if (FSM_QUEUE != 0)
+        fsmHandle->notifyArg = sched;
+        fsmHandle->notifyFunc = fsmSchedNotify;
+#endif
+        sched->nrOfFsms++;
+    }
+    return id;
+}
+
+/**
+ * @brief Mark a fsm instance ready. Can be called from interrupt context.
+ *
+ * @param sched - scheduler instance
+ * @param id - scheduler id of the fsm instance
+ */
+void fsmSchedSetReady(FsmSched_t* sched, const uint16_t id)
+{
+    if (id < sched->nrOfFsms)
+    {
+        atomic_fetch_or_explicit(&sched->groups[id >> 5], 0x80000000U >> (id & 31U), memory_order_release);
+        atomic_fetch_or_explicit(&sched->summary, 0x80000000U >> (id >> 5), memory_order_release);
+    }
+}
+
+/**
+ * @brief Select the ready fsm instance with the highest priority and
+ *        dispatch one event to it. If the instance has no queue,
+ *        it is executed once with FSM_EVENT_TICK.
+ *
+ * @param sched - scheduler instance
+ * @return >= 0 - scheduler id of the executed instance
+ *           -1 - no instance is ready
+ */
+int16_t fsmSchedRunNext(FsmSched_t* sched)
+{
+    int16_t id = -1;
+    uint32_t summary = atomic_load_explicit(&sched->summary, memory_order_acquire);
+
+    while ((id < 0) && (0 != summary))
+    {
+        uint8_t group = fsmSchedClz(summary);
+        uint32_t groupBit = 0x80000000U >> group;
+        uint32_t ready;
+
+        /* clear the summary bit first, a producer that sets a group bit afterwards sets it again */
+        atomic_fetch_and_explicit(&sched->summary, ~groupBit, memory_order_acq_rel);
+        ready = atomic_load_explicit(&sched->groups[group], memory_order_acquire);
+
+        if (0 != ready)
+        {
+            uint8_t bit = fsmSchedClz(ready);
+            uint32_t fsmBit = 0x80000000U >> bit;
+
+            ready = atomic_fetch_and_explicit(&sched->groups[group], ~fsmBit, memory_order_acq_rel) & ~fsmBit;
+            if (0 != ready)
+            {
+                atomic_fetch_or_explicit(&sched->summary, groupBit, memory_order_release);
+            }
+            id = (int16_t)(((uint16_t)group << 5) | bit);
+        }
+        summary = atomic_load_explicit(&sched->summary, memory_order_acquire);
+    }
+
+    if (id >= 0)
+    {
+        FsmHandle_t* fsmHandle = sched->handles[id];
+
+#if (FSM_QUEUE != 0)
+        if (NULL != fsmHandle->queue)
+        {
+            FsmEvent_t event;
+
+            if (0 == fsmQueueGet(fsmHandle->queue, &event))
+            {
+                fsmDispatch(fsmHandle, event);
+            }
+            if (0 == fsmQueueIsEmpty(fsmHandle->queue))
+            {
+                fsmSchedSetReady(sched, (uint16_t)id);
+            }
+        }
+        else
+#endif
+        {
+            fsmRun(fsmHandle);
+        }
+    }
+    return id;
+}
+
+/**
+ * @brief Check if no fsm instance is ready, e.g. before entering sleep mode.
+ *
+ * @param sched - scheduler instance
+ * @return 1 - no instance is ready
+ *         0 - at least one instance is ready
+ */
+uint8_t fsmSchedIsIdle(FsmSched_t* sched)
+{
+    return (0 == atomic_load_explicit(&sched->summary, memory_order_acquire)) ? 1 : 0;
+}
+
+/**
+ * @brief Get the ticks until the scheduler needs to run again, e.g. to
+ *        suppress the tick in idle: 0 if an instance is ready (queued
+ *        events), else the next expiry of the timer wheel.
+ *
+ * @param sched - scheduler instance
+ * @param wheel - timer wheel of the instances, NULL if they use no timers
+ * @param ticks - [out] ticks until the next wakeup, 0 = run now
+ * @return  0 - wakeup in ticks
+ *         -1 - nothing is ready and no timer is running, wait for an interrupt
+ */
+int8_t fsmSchedNextWakeup(FsmSched_t* sched, const FsmTimerWheel_t* wheel, uint32_t* ticks)
+{
+    int8_t wakeup = 0;
+
+    if (0 == fsmSchedIsIdle(sched))
+    {
+        *ticks = 0;
+    }
+    else if (NULL != wheel)
+    {
+        wakeup = fsmTimerNextExpiry(wheel, ticks);
+    }
+    else
+    {
+        wakeup = -1;
+    }
+    return wakeup;
+}
@@ -0,0 +1,127 @@
+/********************************************************************************
+ * @file           : fsmSched.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Cooperative scheduler for FSM instances
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * The scheduler owns a list of FSM instances and keeps a ready bitmap.
+ * An instance is marked ready when an event is posted to its queue
+ * (fsmPost() / fsmPostMulti()) or with fsmSchedSetReady(), e.g. from a
+ * timer. fsmSchedRunNext() selects the ready instance with the highest
+ * priority using count leading zeros, so selection is O(1) instead of
+ * polling every instance. If nothing is ready, the caller can sleep.
+ *
+ * The priority of an instance is its scheduler id, the order in which it
+ * was added with fsmSchedAdd(): the first instance has the highest priority.
+ *
+ * Every selection dispatches one event of the instance queue (or a
+ * FSM_EVENT_TICK if the instance has no queue), so a higher priority
+ * instance that became ready meanwhile is selected next. Queues and the
+ * notify hook of the instances need FSM_QUEUE = 1, without it the
+ * instances are only marked ready with fsmSchedSetReady().
+ *
+ * The ready bitmap has two levels (one summary word with one bit per group
+ * of 32 instances), so up to FSM_SCHED_MAX_NR_OF_FSMS instances are supported.
+ * fsmSchedSetReady() and the post functions are interrupt safe, they need
+ * an atomic fetch-or (not available on Cortex-M0).
+ *
+ * Example usage:
+ *
+ *     static FsmHandle_t* schedHandles[NR_OF_FSMS];
+ *     static FsmSchedGroup_t schedGroups[FSM_SCHED_NR_OF_GROUPS(NR_OF_FSMS)];
+ *     static FsmSched_t sched;
+ *
+ *     fsmSchedInit(&sched, schedHandles, schedGroups, NR_OF_FSMS);
+ *     fsmSchedAdd(&sched, &uartFsm);   // highest priority
+ *     fsmSchedAdd(&sched, &buttonFsm);
+ *
+ *     while (1)
+ *     {
+ *         while (fsmSchedRunNext(&sched) >= 0)
+ *         {
+ *         }
+ *         sleepUntilInterrupt();
+ *     }
+ *
+ * Tickless idle: fsmSchedNextWakeup() combines the ready bitmap with the
+ * next expiry of the timer wheel, so the tick can be suppressed until then:
+ *
+ *     while (1)
+ *     {
+ *         uint32_t ticks;
+ *
+ *         while (fsmSchedRunNext(&sched) >= 0)
+ *         {
+ *         }
+ *         if (0 == fsmSchedNextWakeup(&sched, &timerWheel, &ticks))
+ *         {
+ *             sleepTicks(ticks); // 0 = an instance got ready meanwhile
+ *         }
+ *         else
+ *         {
+ *             sleepUntilInterrupt();
+ *         }
+ *         fsmTimerAdvance(&timerWheel, sysTicksElapsed());
+ *     }
+ *
+ ********************************************************************************/
+
+#ifndef FSM_SCHED_H
+#define FSM_SCHED_H
+
+#include "stdint.h"
+#ifndef __cplusplus
+#include "stdatomic.h"
+#endif
+#include "fsm.h"
+#include "fsmTimer.h"
+
+#define FSM_SCHED_MAX_NR_OF_FSMS  (uint16_t)1024U
+
+/* Number of ready bitmap groups needed for n instances. */
+#define FSM_SCHED_NR_OF_GROUPS(n)  (((n) + 31U) / 32U)
+
+typedef FSM_ATOMIC(uint32_t) FsmSchedGroup_t;
+
+typedef struct
+{
+    FsmHandle_t** handles;
+    FsmSchedGroup_t* groups;
+    FSM_ATOMIC(uint32_t) summary;
+    uint16_t nrOfFsms;
+    uint16_t maxNrOfFsms;
+} FsmSched_t;
+
+int8_t fsmSchedInit(FsmSched_t* sched, FsmHandle_t** handles, FsmSchedGroup_t* groups, const uint16_t maxNrOfFsms);
+int16_t fsmSchedAdd(FsmSched_t* sched, FsmHandle_t* fsmHandle);
+void fsmSchedSetReady(FsmSched_t* sched, const uint16_t id);
+int16_t fsmSchedRunNext(FsmSched_t* sched);
+uint8_t fsmSchedIsIdle(FsmSched_t* sched);
+int8_t fsmSchedNextWakeup(FsmSched_t* sched, const FsmTimerWheel_t* wheel, uint32_t* ticks);
+
+#endif /* FSM_SCHED_H */
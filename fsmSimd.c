@@ -0,0 +1,242 @@
+/********************************************************************************
+ * @file           : fsmSimd.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Vectorized transition kernel for pure table driven FSMs
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmSimd.h"
+#include "stddef.h"
+
+#if (FSM_SIMD != 0) && defined(__AVX2__)
+#include "immintrin.h"
+#define FSM_SIMD_AVX2
+#elif (FSM_SIMD != 0) && defined(__SSSE3__)
+#include "tmmintrin.h"
+#define FSM_SIMD_SSSE3
+#elif (FSM_SIMD != 0) && defined(__aarch64__) && defined(__ARM_NEON)
+#include "arm_neon.h"
+#define FSM_SIMD_NEON
+#endif
+
+/**
+ * @brief Initialize a transition table. All next states must be valid.
+ *
+ * @param table - table instance
+ * @param next - next state of every state and symbol, nrOfStates * nrOfSymbols items
+ * @param nrOfStates - number of states (1 - 255)
+ * @param nrOfSymbols - number of input symbols (1 - 255)
+ * @return  0 - table initialized
+ *         -1 - invalid table, number of states / symbols or next state
+ */
+int8_t fsmSimdInit(FsmSimdTable_t* table, const uint8_t* next, const uint8_t nrOfStates, const uint8_t nrOfSymbols)
+{
+    int8_t tableInitialized = -1;
+
+    table->next = NULL;
+    table->nrOfStates = 0;
+    table->nrOfSymbols = 0;
+    table->shuffle = 0;
+
+    if ((NULL != next) && (nrOfStates > 0) && (nrOfSymbols > 0))
+    {
+        tableInitialized = 0;
+
+        for (uint16_t i = 0; i < ((uint16_t)nrOfStates * nrOfSymbols); i++)
+        {
+            if (next[i] >= nrOfStates)
+            {
+                tableInitialized = -1;
+            }
+        }
+    }
+
+    if (0 == tableInitialized)
+    {
+        table->next = next;
+        table->nrOfStates = nrOfStates;
+        table->nrOfSymbols = nrOfSymbols;
+
+        if ((nrOfStates <= FSM_SIMD_MAX_NR_OF_STATES) && (nrOfSymbols <= FSM_SIMD_MAX_NR_OF_SYMBOLS))
+        {
+            /* transpose, unused lanes (state >= nrOfStates) are never used as index */
+            for (uint8_t symbol = 0; symbol < nrOfSymbols; symbol++)
+            {
+                for (uint8_t state = 0; state < FSM_SIMD_MAX_NR_OF_STATES; state++)
+                {
+                    table->columns[symbol][state] = (state < nrOfStates) ? next[state * nrOfSymbols + symbol] : 0;
+                }
+            }
+            table->shuffle = 1;
+        }
+    }
+    return tableInitialized;
+}
+
+/**
+ * @brief Advance instances with the scalar loop.
+ *
+ * @param table - table instance
+ * @param states - current state of every instance, updated
+ * @param symbols - input symbol of every instance
+ * @param count - number of instances
+ */
+static void fsmSimdStepScalar(const FsmSimdTable_t* table, uint8_t* states, const uint8_t* symbols, const uint32_t count)
+{
+    const uint8_t* next = table->next;
+    uint8_t nrOfSymbols = table->nrOfSymbols;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (symbols[i] < nrOfSymbols)
+        {
+            states[i] = next[states[i] * nrOfSymbols + symbols[i]];
+        }
+    }
+}
+
+#if defined(FSM_SIMD_AVX2)
+/**
+ * @brief Advance instances 32 at a time with byte shuffles (AVX2).
+ *
+ * @param table - table instance, shuffle kernel must be enabled
+ * @param states - current state of every instance, updated
+ * @param symbols - input symbol of every instance
+ * @param count - number of instances
+ * @return number of instances that were advanced (multiple of 32)
+ */
+static uint32_t fsmSimdStepShuffle(const FsmSimdTable_t* table, uint8_t* states, const uint8_t* symbols, const uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; (i + 32U) <= count; i += 32U)
+    {
+        __m256i state = _mm256_loadu_si256((const __m256i*)&states[i]);
+        __m256i symbol = _mm256_loadu_si256((const __m256i*)&symbols[i]);
+        __m256i stateNext = state;
+
+        for (uint8_t s = 0; s < table->nrOfSymbols; s++)
+        {
+            /* shuffle works per 128 bit lane, so the column is in both lanes */
+            __m256i column = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)table->columns[s]));
+            __m256i match = _mm256_cmpeq_epi8(symbol, _mm256_set1_epi8((char)s));
+
+            stateNext = _mm256_blendv_epi8(stateNext, _mm256_shuffle_epi8(column, state), match);
+        }
+        _mm256_storeu_si256((__m256i*)&states[i], stateNext);
+    }
+    return i;
+}
+#elif defined(FSM_SIMD_SSSE3)
+/**
+ * @brief Advance instances 16 at a time with byte shuffles (SSSE3).
+ *
+ * @param table - table instance, shuffle kernel must be enabled
+ * @param states - current state of every instance, updated
+ * @param symbols - input symbol of every instance
+ * @param count - number of instances
+ * @return number of instances that were advanced (multiple of 16)
+ */
+static uint32_t fsmSimdStepShuffle(const FsmSimdTable_t* table, uint8_t* states, const uint8_t* symbols, const uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; (i + 16U) <= count; i += 16U)
+    {
+        __m128i state = _mm_loadu_si128((const __m128i*)&states[i]);
+        __m128i symbol = _mm_loadu_si128((const __m128i*)&symbols[i]);
+        __m128i stateNext = state;
+
+        for (uint8_t s = 0; s < table->nrOfSymbols; s++)
+        {
+            __m128i column = _mm_load_si128((const __m128i*)table->columns[s]);
+            __m128i match = _mm_cmpeq_epi8(symbol, _mm_set1_epi8((char)s));
+
+            /* SSSE3 has no byte blend, select with and / andnot */
+            stateNext = _mm_or_si128(_mm_and_si128(match, _mm_shuffle_epi8(column, state)), _mm_andnot_si128(match, stateNext));
+        }
+        _mm_storeu_si128((__m128i*)&states[i], stateNext);
+    }
+    return i;
+}
+#elif defined(FSM_SIMD_NEON)
+/**
+ * @brief Advance instances 16 at a time with table lookups (NEON).
+ *
+ * @param table - table instance, shuffle kernel must be enabled
+ * @param states - current state of every instance, updated
+ * @param symbols - input symbol of every instance
+ * @param count - number of instances
+ * @return number of instances that were advanced (multiple of 16)
+ */
+static uint32_t fsmSimdStepShuffle(const FsmSimdTable_t* table, uint8_t* states, const uint8_t* symbols, const uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; (i + 16U) <= count; i += 16U)
+    {
+        uint8x16_t state = vld1q_u8(&states[i]);
+        uint8x16_t symbol = vld1q_u8(&symbols[i]);
+        uint8x16_t stateNext = state;
+
+        for (uint8_t s = 0; s < table->nrOfSymbols; s++)
+        {
+            uint8x16_t column = vld1q_u8(table->columns[s]);
+            uint8x16_t match = vceqq_u8(symbol, vdupq_n_u8(s));
+
+            stateNext = vbslq_u8(match, vqtbl1q_u8(column, state), stateNext);
+        }
+        vst1q_u8(&states[i], stateNext);
+    }
+    return i;
+}
+#endif
+
+/**
+ * @brief Advance every instance by one symbol:
+ *        states[i] = next[states[i] * nrOfSymbols + symbols[i]].
+ *        Instances with a symbol >= nrOfSymbols keep their state.
+ *
+ * @param table - table instance
+ * @param states - current state of every instance (count items), updated
+ * @param symbols - input symbol of every instance (count items)
+ * @param count - number of instances
+ */
+void fsmSimdStep(const FsmSimdTable_t* table, uint8_t* states, const uint8_t* symbols, const uint32_t count)
+{
+    uint32_t done = 0;
+
+#if defined(FSM_SIMD_AVX2) || defined(FSM_SIMD_SSSE3) || defined(FSM_SIMD_NEON)
+    if (0 != table->shuffle)
+    {
+        done = fsmSimdStepShuffle(table, states, symbols, count);
+    }
+#endif
+
+    /* remaining instances and machines that are too large for the shuffle kernel */
+    fsmSimdStepScalar(table, &states[done], &symbols[done], count - done);
+}
@@ -0,0 +1,107 @@
+/********************************************************************************
+ * @file           : fsmSimd.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Vectorized transition kernel for pure table driven FSMs
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Kernel that advances many instances of a pure table driven machine at
+ * once: the next state only depends on the current state and an input
+ * symbol (tokenizers, protocol framers, debouncers), there are no state,
+ * entry or exit functions. The transition table is a byte array with
+ * next[state * nrOfSymbols + symbol]. The states of the instances are a
+ * packed uint8_t array, the same layout the batch module uses (see fsmBatch.h).
+ *
+ * Machines with up to 16 states and up to FSM_SIMD_MAX_NR_OF_SYMBOLS
+ * symbols are stepped with byte shuffles: per symbol, the column of next
+ * states is one 16 byte register and the current states are the shuffle
+ * indices, so one instruction looks up 16 (SSSE3 / NEON) or 32 (AVX2)
+ * instances. The results are merged by comparing the symbols of the
+ * instances. Larger machines and targets without SIMD use the scalar loop.
+ * The instruction set is selected at compile time from the compiler target
+ * (e.g. -mssse3, -mavx2, AArch64), FSM_SIMD = 0 forces the scalar loop.
+ *
+ * Symbols >= nrOfSymbols keep the state of the instance.
+ *
+ * Example usage (debouncer with states low, rising, high, falling,
+ * symbol = raw input level 0 / 1):
+ *
+ *     static const uint8_t debounceNext[4 * 2] =
+ *     {
+ *         DEBOUNCE_LOW,     DEBOUNCE_RISING,
+ *         DEBOUNCE_LOW,     DEBOUNCE_HIGH,
+ *         DEBOUNCE_FALLING, DEBOUNCE_HIGH,
+ *         DEBOUNCE_LOW,     DEBOUNCE_HIGH,
+ *     };
+ *     static FsmSimdTable_t debounceTable;
+ *     static uint8_t debounceStates[NR_OF_INPUTS];
+ *
+ *     fsmSimdInit(&debounceTable, debounceNext, 4, 2);
+ *
+ *     void timerTick(void)
+ *     {
+ *         uint8_t levels[NR_OF_INPUTS];
+ *
+ *         readInputs(levels);
+ *         fsmSimdStep(&debounceTable, debounceStates, levels, NR_OF_INPUTS);
+ *     }
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_SIMD_H
+#define FSM_SIMD_H
+
+#include "stdint.h"
+#include "fsm.h"
+
+/* Use SIMD instructions if the compiler targets them, 0 = scalar loop only. */
+#ifndef FSM_SIMD
+#define FSM_SIMD  1
+#endif
+
+/* Max number of states of the shuffle kernel (one register of next states). */
+#define FSM_SIMD_MAX_NR_OF_STATES   16U
+
+/* Max number of symbols of the shuffle kernel, it needs one shuffle per symbol. */
+#ifndef FSM_SIMD_MAX_NR_OF_SYMBOLS
+#define FSM_SIMD_MAX_NR_OF_SYMBOLS  16U
+#endif
+
+typedef struct
+{
+    const uint8_t* next; /* next state: next[state * nrOfSymbols + symbol] */
+    uint8_t nrOfStates;
+    uint8_t nrOfSymbols;
+    uint8_t shuffle;     /* 1 if the shuffle kernel is used */
+    FSM_ALIGNAS(16) uint8_t columns[FSM_SIMD_MAX_NR_OF_SYMBOLS][FSM_SIMD_MAX_NR_OF_STATES]; /* next states per symbol */
+} FsmSimdTable_t;
+
+int8_t fsmSimdInit(FsmSimdTable_t* table, const uint8_t* next, const uint8_t nrOfStates, const uint8_t nrOfSymbols);
+void fsmSimdStep(const FsmSimdTable_t* table, uint8_t* states, const uint8_t* symbols, const uint32_t count);
+
+#endif /* FSM_SIMD_H */
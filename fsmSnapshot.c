@@ -0,0 +1,355 @@
+/********************************************************************************
+ * @file           : fsmSnapshot.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Snapshot and restore of FSM instances for warm restarts
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmSnapshot.h"
+#include "fsmQueue.h"
+#include "fsmTimer.h"
+#include "fsmExport.h"
+#include "stddef.h"
+
+#define FSM_SNAPSHOT_FNV_OFFSET  2166136261UL
+#define FSM_SNAPSHOT_FNV_PRIME   16777619UL
+
+#define FSM_SNAPSHOT_HEADER_SIZE    18U
+#define FSM_SNAPSHOT_CHECKSUM_SIZE  4U
+
+#define FSM_SNAPSHOT_FLAG_TIMER_RUNNING  0x01U /* state timeout is running */
+#define FSM_SNAPSHOT_FLAG_TIMER_EXPIRED  0x02U /* timeout is queued and not dispatched yet */
+
+/**
+ * @brief Add the bytes of a value to a FNV-1a hash (little endian order).
+ *
+ * @param hash - hash so far
+ * @param value - value to add
+ * @param nrOfBytes - number of bytes of the value
+ * @return new hash
+ */
+static uint32_t fsmSnapshotHash(uint32_t hash, uintptr_t value, const uint8_t nrOfBytes)
+{
+    for (uint8_t i = 0; i < nrOfBytes; i++)
+    {
+        hash ^= (uint8_t)value;
+        hash *= FSM_SNAPSHOT_FNV_PRIME;
+        value >>= 8;
+    }
+    return hash;
+}
+
+/**
+ * @brief Add a byte array to a FNV-1a hash.
+ *
+ * @param hash - hash so far
+ * @param data - bytes to add
+ * @param size - number of bytes
+ * @return new hash
+ */
+static uint32_t fsmSnapshotHashBytes(uint32_t hash, const uint8_t* data, const uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= FSM_SNAPSHOT_FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Write a value little endian to a buffer.
+ *
+ * @param buffer - destination
+ * @param value - value to write
+ * @param nrOfBytes - number of bytes of the value
+ */
+static void fsmSnapshotWrite(uint8_t* buffer, uint32_t value, const uint8_t nrOfBytes)
+{
+    for (uint8_t i = 0; i < nrOfBytes; i++)
+    {
+        buffer[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+/**
+ * @brief Read a little endian value from a buffer.
+ *
+ * @param buffer - source
+ * @param nrOfBytes - number of bytes of the value
+ * @return value
+ */
+static uint32_t fsmSnapshotRead(const uint8_t* buffer, const uint8_t nrOfBytes)
+{
+    uint32_t value = 0;
+
+    for (uint8_t i = nrOfBytes; i > 0; i--)
+    {
+        value = (value << 8) | buffer[i - 1];
+    }
+    return value;
+}
+
+/**
+ * @brief Hash of a fsm definition: number of states, state table
+ *        (function addresses and timeouts), transitions with their input
+ *        guards, hierarchy and error function. Any change of the
+ *        definition or a firmware build that moves the functions changes
+ *        the hash.
+ *
+ * @param fsmDef - fsm definition
+ * @return FNV-1a hash of the definition
+ */
+uint32_t fsmDefHash(const FsmDef_t* fsmDef)
+{
+    uint32_t hash = FSM_SNAPSHOT_FNV_OFFSET;
+
+    hash = fsmSnapshotHash(hash, fsmDef->nrOfStates, 1);
+    hash = fsmSnapshotHash(hash, (uintptr_t)fsmDef->errorFunc, sizeof(uintptr_t));
+
+    for (uint16_t state = 0; state < fsmDef->nrOfStates; state++)
+    {
+        const FsmStateDef_t* stateDef = &fsmDef->table[state];
+
+        hash = fsmSnapshotHash(hash, (uintptr_t)stateDef->stateFunc, sizeof(uintptr_t));
+        hash = fsmSnapshotHash(hash, (uintptr_t)stateDef->onEntryFunc, sizeof(uintptr_t));
+        hash = fsmSnapshotHash(hash, (uintptr_t)stateDef->onExitFunc, sizeof(uintptr_t));
+        hash = fsmSnapshotHash(hash, stateDef->timeout, 4);
+        hash = fsmSnapshotHash(hash, (NULL != fsmDef->parents) ? fsmDef->parents[state] : FSM_NO_PARENT, 1);
+    }
+
+    if (NULL != fsmDef->transitions)
+    {
+        for (uint16_t i = 0; i < fsmDef->transitionIndex[fsmDef->nrOfStates]; i++)
+        {
+            const FsmTransition_t* transition = &fsmDef->transitions[i];
+
+            hash = fsmSnapshotHash(hash, transition->state, 1);
+            hash = fsmSnapshotHash(hash, transition->event, sizeof(FsmEvent_t));
+            hash = fsmSnapshotHash(hash, (uintptr_t)transition->guardFunc, sizeof(uintptr_t));
+            hash = fsmSnapshotHash(hash, (uintptr_t)transition->actionFunc, sizeof(uintptr_t));
+            hash = fsmSnapshotHash(hash, transition->nextState, 1);
+            if (NULL != fsmDef->inputGuards)
+            {
+                hash = fsmSnapshotHash(hash, fsmDef->inputGuards[i].mask, 4);
+                hash = fsmSnapshotHash(hash, fsmDef->inputGuards[i].value, 4);
+            }
+        }
+    }
+    return hash;
+}
+
+/**
+ * @brief Get the queue of an instance.
+ *
+ * @param fsmHandle - fsm instance
+ * @return attached queue, NULL if none is attached or FSM_QUEUE = 0
+ */
+static FsmQueue_t* fsmSnapshotQueue(const FsmHandle_t* fsmHandle)
+{
+#if (FSM_QUEUE != 0)
+    return fsmHandle->queue;
+#else
+    (void)fsmHandle;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Get the timer of an instance.
+ *
+ * @param fsmHandle - fsm instance
+ * @return attached timer, NULL if none is attached or FSM_TIMER = 0
+ */
+static FsmTimer_t* fsmSnapshotTimer(const FsmHandle_t* fsmHandle)
+{
+#if (FSM_TIMER != 0)
+    return fsmHandle->timer;
+#else
+    (void)fsmHandle;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Save the runtime state of a fsm instance (current state, state
+ *        timeout and queued events) to a buffer. The queue is not changed.
+ *
+ * @param fsmHandle - fsm instance
+ * @param buffer - [out] snapshot buffer
+ * @param size - size of the buffer, FSM_SNAPSHOT_SIZE(queue size) is always enough
+ * @param length - [out] number of bytes written
+ * @return  0 - snapshot saved
+ *         -1 - buffer too small
+ */
+int8_t fsmSnapshotSave(FsmHandle_t* fsmHandle, uint8_t* buffer, const uint16_t size, uint16_t* length)
+{
+    int8_t snapshotSaved = -1;
+    FsmQueue_t* queue = fsmSnapshotQueue(fsmHandle);
+    FsmTimer_t* timer = fsmSnapshotTimer(fsmHandle);
+    uint16_t nrOfEvents = 0;
+    uint32_t remaining = 0;
+    uint8_t flags = 0;
+
+    *length = 0;
+
+    if (size >= FSM_SNAPSHOT_SIZE(0))
+    {
+        snapshotSaved = 0;
+
+        if (NULL != queue)
+        {
+            uint32_t pos = queue->tail;
+
+            /* read the pending events without taking them (same check as fsmQueueGet()) */
+            while ((0 == snapshotSaved) &&
+                   (atomic_load_explicit(&queue->slots[pos & queue->mask].sequence, memory_order_acquire) == (pos + 1)))
+            {
+                if (FSM_SNAPSHOT_SIZE(nrOfEvents + 1U) > size)
+                {
+                    snapshotSaved = -1;
+                }
+                else
+                {
+                    buffer[FSM_SNAPSHOT_HEADER_SIZE + nrOfEvents] = queue->slots[pos & queue->mask].event;
+                    nrOfEvents++;
+                    pos++;
+                }
+            }
+        }
+    }
+
+    if (0 == snapshotSaved)
+    {
+        if (NULL != timer)
+        {
+            if (NULL != timer->pprev)
+            {
+                flags |= FSM_SNAPSHOT_FLAG_TIMER_RUNNING;
+                remaining = timer->expiry - timer->wheel->now;
+            }
+            if (0 != timer->expired)
+            {
+                flags |= FSM_SNAPSHOT_FLAG_TIMER_EXPIRED;
+            }
+        }
+
+        fsmSnapshotWrite(&buffer[0], FSM_SNAPSHOT_MAGIC, 4);
+        buffer[4] = FSM_SNAPSHOT_VERSION;
+        buffer[5] = fsmHandle->currentState;
+        buffer[6] = flags;
+        buffer[7] = 0;
+        fsmSnapshotWrite(&buffer[8], fsmDefHash(fsmHandle->def), 4);
+        fsmSnapshotWrite(&buffer[12], remaining, 4);
+        fsmSnapshotWrite(&buffer[16], nrOfEvents, 2);
+        fsmSnapshotWrite(&buffer[FSM_SNAPSHOT_HEADER_SIZE + nrOfEvents],
+                         fsmSnapshotHashBytes(FSM_SNAPSHOT_FNV_OFFSET, buffer, FSM_SNAPSHOT_HEADER_SIZE + nrOfEvents), 4);
+        *length = FSM_SNAPSHOT_SIZE(nrOfEvents);
+    }
+    return snapshotSaved;
+}
+
+/**
+ * @brief Restore the runtime state of a fsm instance from a snapshot.
+ *        The entry function of the restored state is not called.
+ *        The snapshot is validated first, an invalid snapshot does not
+ *        change the instance.
+ *
+ * @param fsmHandle - fsm instance, initialized with the same definition,
+ *                    queue and timer attached (if used), queue empty
+ * @param buffer - snapshot buffer
+ * @param length - number of bytes in the buffer
+ * @return  0 - instance restored
+ *         -1 - invalid or corrupted snapshot, changed definition, or
+ *              queue / timer of the instance do not fit
+ */
+int8_t fsmSnapshotRestore(FsmHandle_t* fsmHandle, const uint8_t* buffer, const uint16_t length)
+{
+    int8_t snapshotRestored = -1;
+    FsmQueue_t* queue = fsmSnapshotQueue(fsmHandle);
+    FsmTimer_t* timer = fsmSnapshotTimer(fsmHandle);
+    uint16_t nrOfEvents = 0;
+    uint8_t flags = 0;
+
+    if (length >= FSM_SNAPSHOT_SIZE(0))
+    {
+        nrOfEvents = (uint16_t)fsmSnapshotRead(&buffer[16], 2);
+        flags = buffer[6];
+
+        if ((FSM_SNAPSHOT_MAGIC == fsmSnapshotRead(&buffer[0], 4)) &&
+            (FSM_SNAPSHOT_VERSION == buffer[4]) &&
+            (FSM_SNAPSHOT_SIZE(nrOfEvents) <= length) &&
+            (fsmSnapshotRead(&buffer[FSM_SNAPSHOT_HEADER_SIZE + nrOfEvents], 4) ==
+             fsmSnapshotHashBytes(FSM_SNAPSHOT_FNV_OFFSET, buffer, FSM_SNAPSHOT_HEADER_SIZE + nrOfEvents)) &&
+            (fsmSnapshotRead(&buffer[8], 4) == fsmDefHash(fsmHandle->def)) &&
+            (buffer[5] < fsmHandle->def->nrOfStates))
+        {
+            snapshotRestored = 0;
+        }
+    }
+
+    if ((0 == snapshotRestored) && (nrOfEvents > 0) &&
+        ((NULL == queue) || (0 == fsmQueueIsEmpty(queue)) || (nrOfEvents > (queue->mask + 1))))
+    {
+        snapshotRestored = -1;
+    }
+
+    if ((0 == snapshotRestored) && (0 != (flags & (FSM_SNAPSHOT_FLAG_TIMER_RUNNING | FSM_SNAPSHOT_FLAG_TIMER_EXPIRED))) &&
+        (NULL == timer))
+    {
+        snapshotRestored = -1;
+    }
+
+    if (0 == snapshotRestored)
+    {
+        fsmHandle->currentState = buffer[5];
+#if (FSM_EXPORT != 0)
+        fsmExportWrite(fsmHandle->exportSlot, fsmHandle->id, fsmHandle->currentState);
+#endif
+
+        if (NULL != timer)
+        {
+            /* fsmAttachTimer() may have started the timer for the init state */
+            fsmTimerStop(timer);
+            if (0 != (flags & FSM_SNAPSHOT_FLAG_TIMER_RUNNING))
+            {
+                fsmTimerStart(timer, fsmSnapshotRead(&buffer[12], 4));
+            }
+            if (0 != (flags & FSM_SNAPSHOT_FLAG_TIMER_EXPIRED))
+            {
+                timer->expired = 1;
+            }
+        }
+
+        for (uint16_t i = 0; i < nrOfEvents; i++)
+        {
+            (void)fsmPost(fsmHandle, buffer[FSM_SNAPSHOT_HEADER_SIZE + i]);
+        }
+    }
+    return snapshotRestored;
+}
@@ -0,0 +1,103 @@
+/********************************************************************************
+ * @file           : fsmSnapshot.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Snapshot and restore of FSM instances for warm restarts
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Snapshot and restore of the runtime part of a fsm instance for a warm
+ * restart, e.g. after a watchdog reset. The snapshot is a compact byte
+ * buffer that can be kept in retained RAM (no init section) or written to
+ * flash:
+ *   - current state
+ *   - remaining ticks of the state timeout (if a timer is attached, FSM_TIMER = 1)
+ *   - events that are still queued (if a queue is attached, FSM_QUEUE = 1)
+ *   - hash of the definition (see fsmDefHash())
+ *   - checksum of the whole snapshot
+ *
+ * On restore the snapshot is validated first (magic, version, checksum,
+ * definition hash, queue / timer capacity), an invalid snapshot leaves the
+ * instance untouched, so it can fall back to its init state. The hash
+ * covers the structure of the definition and the addresses of all
+ * functions, so a changed definition or a new firmware build that moves
+ * the functions invalidates the snapshot. Restoring skips the entry
+ * functions: the instance continues in the saved state as if it had never
+ * been reset. Data that the state functions keep in the context must be
+ * retained by the application.
+ *
+ * fsmSnapshotSave() must be called from the context that runs the fsm.
+ * Events posted concurrently by other contexts may or may not be included.
+ * fsmSnapshotRestore() must be called after fsmInit(), fsmAttachQueue() and
+ * fsmAttachTimer() and before other contexts post events to the instance.
+ *
+ * Format (little endian, independent of the target):
+ *     uint32 magic FSM_SNAPSHOT_MAGIC, uint8 version, uint8 state,
+ *     uint8 flags, uint8 reserved, uint32 definition hash,
+ *     uint32 remaining timer ticks, uint16 number of events, events,
+ *     uint32 checksum (FNV-1a of all previous bytes)
+ *
+ * Example usage:
+ *
+ *     static uint8_t linkFsmSnapshot[FSM_SNAPSHOT_SIZE(16)] __attribute__((section(".noinit")));
+ *
+ *     fsmInit(&linkFsm, &linkFsmDef, LINK_STATE_INIT, &link);
+ *     fsmAttachQueue(&linkFsm, &linkFsmQueue);
+ *     fsmAttachTimer(&linkFsm, &linkFsmTimer, &timerWheel);
+ *
+ *     if (0 != fsmSnapshotRestore(&linkFsm, linkFsmSnapshot, sizeof(linkFsmSnapshot)))
+ *     {
+ *         linkRestart(&link);
+ *     }
+ *
+ *     while (1)
+ *     {
+ *         uint16_t length;
+ *
+ *         fsmProcess(&linkFsm);
+ *         fsmSnapshotSave(&linkFsm, linkFsmSnapshot, sizeof(linkFsmSnapshot), &length);
+ *     }
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_SNAPSHOT_H
+#define FSM_SNAPSHOT_H
+
+#include "stdint.h"
+#include "fsm.h"
+
+#define FSM_SNAPSHOT_MAGIC    0x534D5346UL /* "FSMS" */
+#define FSM_SNAPSHOT_VERSION  1U
+
+/* Size of a snapshot buffer of an instance whose queue holds up to nrOfEvents events. */
+#define FSM_SNAPSHOT_SIZE(nrOfEvents)  (22U + (uint16_t)(nrOfEvents))
+
+uint32_t fsmDefHash(const FsmDef_t* fsmDef);
+int8_t fsmSnapshotSave(FsmHandle_t* fsmHandle, uint8_t* buffer, const uint16_t size, uint16_t* length);
+int8_t fsmSnapshotRestore(FsmHandle_t* fsmHandle, const uint8_t* buffer, const uint16_t length);
+
+#endif /* FSM_SNAPSHOT_H */
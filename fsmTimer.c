@@ -0,0 +1,435 @@
+/********************************************************************************
+ * @file           : fsmTimer.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Hierarchical timer wheel for FSM state timeouts
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmTimer.h"
+#include "fsmQueue.h"
+#include "stddef.h"
+
+/*
+ * A timer that expires in less than NR_OF_SLOTS^(level + 1) ticks is kept
+ * in the lowest possible level, slot index is taken from the expiry bits
+ * of that level. Every NR_OF_SLOTS^level ticks the current slot of the
+ * level is cascaded, i.e. its timers are sorted into the lower levels again.
+ * Level 0 slots only hold timers that expire exactly at that tick.
+ * The occupancy bitmaps mirror which slots are not empty.
+ */
+
+/* Bit of a slot in the occupancy bitmap of its level. */
+#define FSM_TIMER_BITMAP_WORD(slot)  ((slot) >> 5)
+#define FSM_TIMER_BITMAP_BIT(slot)   (1UL << ((slot) & 31U))
+
+/**
+ * @brief Count trailing zeros of a non zero 32 bit value.
+ *
+ * @param value - value to check, must not be 0
+ * @return number of trailing zero bits (0 - 31)
+ */
+static inline uint8_t fsmTimerCtz(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint8_t)__builtin_ctz(value);
+#else
+    uint8_t zeros = 0;
+
+    while (0 == (value & 1U))
+    {
+        value >>= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+/**
+ * @brief Find the first occupied slot of a level, starting at a slot
+ *        index and wrapping around.
+ *
+ * @param occupied - occupancy bitmap of the level
+ * @param start - first slot index to check
+ * @return distance from start to the first occupied slot (0 - NR_OF_SLOTS - 1),
+ *         FSM_TIMER_NR_OF_SLOTS if the level is empty
+ */
+static uint32_t fsmTimerFindSlot(const uint32_t* occupied, const uint32_t start)
+{
+    uint32_t distance = FSM_TIMER_NR_OF_SLOTS;
+    uint32_t slot = start;
+
+    /* at most one extra word for the bits in front of start */
+    for (uint32_t scanned = 0; (scanned < (FSM_TIMER_NR_OF_SLOTS + 32UL)) && (FSM_TIMER_NR_OF_SLOTS == distance);)
+    {
+        uint32_t bits = occupied[FSM_TIMER_BITMAP_WORD(slot)] >> (slot & 31U);
+
+        if (0 != bits)
+        {
+            distance = (slot + fsmTimerCtz(bits) - start) & FSM_TIMER_SLOT_MASK;
+        }
+        else
+        {
+            scanned += 32U - (slot & 31U);
+            slot = (slot + 32U - (slot & 31U)) & FSM_TIMER_SLOT_MASK;
+        }
+    }
+    return distance;
+}
+
+/**
+ * @brief Find the next slot of a level that expires (level 0) or is
+ *        cascaded (higher levels).
+ *
+ * @param wheel - timer wheel
+ * @param level - level to check
+ * @param ticks - [out] ticks from now until the slot is processed
+ * @return occupied slot, NULL if the level is empty
+ */
+static FsmTimer_t* const* fsmTimerNextSlot(const FsmTimerWheel_t* wheel, const uint8_t level, uint32_t* ticks)
+{
+    FsmTimer_t* const* head = NULL;
+    uint32_t shift = FSM_TIMER_SLOT_BITS * level;
+    uint32_t start = ((wheel->now >> shift) + 1U) & FSM_TIMER_SLOT_MASK;
+    uint32_t distance = fsmTimerFindSlot(wheel->occupied[level], start);
+
+    if (FSM_TIMER_NR_OF_SLOTS != distance)
+    {
+        /* slot is processed when the bits of the level reach it, lower bits are 0 then */
+        uint32_t tick = ((wheel->now >> shift) + distance + 1U) << shift;
+
+        *ticks = tick - wheel->now;
+        head = &wheel->slots[level][(start + distance) & FSM_TIMER_SLOT_MASK];
+    }
+    return head;
+}
+
+/**
+ * @brief Sort a timer into the wheel according to its expiry.
+ *
+ * @param wheel - timer wheel
+ * @param timer - timer, must not be linked
+ */
+static void fsmTimerInsert(FsmTimerWheel_t* wheel, FsmTimer_t* timer)
+{
+    uint32_t delta = timer->expiry - wheel->now;
+    uint8_t level = 0;
+    uint32_t slot;
+    FsmTimer_t** head;
+
+    while ((level < (FSM_TIMER_NR_OF_LEVELS - 1U)) && (delta >= (1UL << (FSM_TIMER_SLOT_BITS * (level + 1U)))))
+    {
+        level++;
+    }
+
+    slot = (timer->expiry >> (FSM_TIMER_SLOT_BITS * level)) & FSM_TIMER_SLOT_MASK;
+    head = &wheel->slots[level][slot];
+    wheel->occupied[level][FSM_TIMER_BITMAP_WORD(slot)] |= FSM_TIMER_BITMAP_BIT(slot);
+    timer->slot = (uint16_t)((level * FSM_TIMER_NR_OF_SLOTS) + slot);
+    timer->next = *head;
+    if (NULL != timer->next)
+    {
+        timer->next->pprev = &timer->next;
+    }
+    *head = timer;
+    timer->pprev = head;
+}
+
+/**
+ * @brief Remove a timer from its wheel slot.
+ *
+ * @param timer - timer, must be linked
+ */
+static void fsmTimerUnlink(FsmTimer_t* timer)
+{
+    *timer->pprev = timer->next;
+    if (NULL != timer->next)
+    {
+        timer->next->pprev = timer->pprev;
+    }
+    else
+    {
+        uint32_t level = timer->slot / FSM_TIMER_NR_OF_SLOTS;
+        uint32_t slot = timer->slot & FSM_TIMER_SLOT_MASK;
+
+        if (NULL == timer->wheel->slots[level][slot])
+        {
+            timer->wheel->occupied[level][FSM_TIMER_BITMAP_WORD(slot)] &= ~FSM_TIMER_BITMAP_BIT(slot);
+        }
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/**
+ * @brief Signal the timeout to the fsm instance of an expired timer.
+ *        If the queue of the instance is full, the timer is armed again
+ *        for the next tick, so the timeout is delayed but not lost.
+ *
+ * @param timer - expired timer, already unlinked
+ */
+static void fsmTimerExpire(FsmTimer_t* timer)
+{
+    FsmHandle_t* fsmHandle = timer->fsmHandle;
+
+    timer->expired = 1;
+
+#if (FSM_QUEUE != 0)
+    if (NULL != fsmHandle->queue)
+    {
+        if (0 != fsmPostMulti(fsmHandle, FSM_EVENT_TIMEOUT))
+        {
+            timer->expired = 0;
+            timer->expiry = timer->wheel->now + 1U;
+            fsmTimerInsert(timer->wheel, timer);
+        }
+    }
+    else
+#endif
+    {
+        fsmDispatch(fsmHandle, FSM_EVENT_TIMEOUT);
+    }
+}
+
+/**
+ * @brief Initialize a timer wheel.
+ *
+ * @param wheel - timer wheel
+ */
+void fsmTimerWheelInit(FsmTimerWheel_t* wheel)
+{
+    for (uint8_t level = 0; level < FSM_TIMER_NR_OF_LEVELS; level++)
+    {
+        for (uint16_t slot = 0; slot < FSM_TIMER_NR_OF_SLOTS; slot++)
+        {
+            wheel->slots[level][slot] = NULL;
+        }
+        for (uint16_t word = 0; word < FSM_TIMER_BITMAP_WORDS; word++)
+        {
+            wheel->occupied[level][word] = 0;
+        }
+    }
+    wheel->now = 0;
+}
+
+/**
+ * @brief Advance the timer wheel by one tick and signal all timeouts
+ *        that expire at this tick.
+ *
+ * @param wheel - timer wheel
+ */
+void fsmTimerTick(FsmTimerWheel_t* wheel)
+{
+    FsmTimer_t** head;
+
+    wheel->now++;
+
+    for (uint8_t level = 1; level < FSM_TIMER_NR_OF_LEVELS; level++)
+    {
+        FsmTimer_t* timer;
+        uint32_t slot;
+
+        if (0 != (wheel->now & ((1UL << (FSM_TIMER_SLOT_BITS * level)) - 1UL)))
+        {
+            break;
+        }
+
+        slot = (wheel->now >> (FSM_TIMER_SLOT_BITS * level)) & FSM_TIMER_SLOT_MASK;
+        head = &wheel->slots[level][slot];
+        timer = *head;
+        *head = NULL;
+        wheel->occupied[level][FSM_TIMER_BITMAP_WORD(slot)] &= ~FSM_TIMER_BITMAP_BIT(slot);
+
+        while (NULL != timer)
+        {
+            FsmTimer_t* next = timer->next;
+
+            fsmTimerInsert(wheel, timer);
+            timer = next;
+        }
+    }
+
+    /* expire one by one, the fsm may start or stop other timers of this slot */
+    head = &wheel->slots[0][wheel->now & FSM_TIMER_SLOT_MASK];
+    while (NULL != *head)
+    {
+        FsmTimer_t* timer = *head;
+
+        fsmTimerUnlink(timer);
+        fsmTimerExpire(timer);
+    }
+}
+
+/**
+ * @brief Advance the timer wheel by several ticks (e.g. after a tickless
+ *        sleep). Ticks without expiry or cascade are skipped at once.
+ *
+ * @param wheel - timer wheel
+ * @param ticks - number of elapsed ticks
+ */
+void fsmTimerAdvance(FsmTimerWheel_t* wheel, uint32_t ticks)
+{
+    while (ticks > 0)
+    {
+        uint32_t skip = ticks;
+
+        /* every occupied slot has to be processed at its tick */
+        for (uint8_t level = 0; level < FSM_TIMER_NR_OF_LEVELS; level++)
+        {
+            uint32_t slotTicks;
+
+            if ((NULL != fsmTimerNextSlot(wheel, level, &slotTicks)) && (slotTicks < skip))
+            {
+                skip = slotTicks;
+            }
+        }
+
+        wheel->now += skip - 1U;
+        fsmTimerTick(wheel);
+        ticks -= skip;
+    }
+}
+
+/**
+ * @brief Get the ticks until the next timer of the wheel expires,
+ *        e.g. to program the wakeup of a tickless idle.
+ *
+ * @param wheel - timer wheel
+ * @param ticks - [out] ticks until the next expiry (1 - FSM_TIMER_MAX_TICKS)
+ * @return  0 - a timer is running
+ *         -1 - no timer is running
+ */
+int8_t fsmTimerNextExpiry(const FsmTimerWheel_t* wheel, uint32_t* ticks)
+{
+    int8_t timerRunning = -1;
+    uint32_t next = UINT32_MAX;
+    uint32_t slotTicks;
+    FsmTimer_t* const* head = fsmTimerNextSlot(wheel, 0, &slotTicks);
+
+    if (NULL != head)
+    {
+        next = slotTicks; /* level 0 slots expire at their tick */
+    }
+
+    /* a higher level slot is cascaded before its timers expire, the earliest
+     * one may expire before timers of the lower levels */
+    for (uint8_t level = 1; level < FSM_TIMER_NR_OF_LEVELS; level++)
+    {
+        head = fsmTimerNextSlot(wheel, level, &slotTicks);
+
+        if ((NULL != head) && (slotTicks < next))
+        {
+            for (const FsmTimer_t* timer = *head; NULL != timer; timer = timer->next)
+            {
+                uint32_t delta = timer->expiry - wheel->now;
+
+                if (delta < next)
+                {
+                    next = delta;
+                }
+            }
+        }
+    }
+
+    if (UINT32_MAX != next)
+    {
+        *ticks = next;
+        timerRunning = 0;
+    }
+    return timerRunning;
+}
+
+/**
+ * @brief (Re)start a timer. A running timer is restarted.
+ *
+ * @param timer - timer, must be attached to a wheel
+ * @param ticks - ticks until the timer expires (1 - FSM_TIMER_MAX_TICKS),
+ *                values out of range are limited
+ */
+void fsmTimerStart(FsmTimer_t* timer, uint32_t ticks)
+{
+    fsmTimerStop(timer);
+
+    if (0 == ticks)
+    {
+        ticks = 1;
+    }
+    else if (ticks > FSM_TIMER_MAX_TICKS)
+    {
+        ticks = FSM_TIMER_MAX_TICKS;
+    }
+
+    timer->expiry = timer->wheel->now + ticks;
+    fsmTimerInsert(timer->wheel, timer);
+}
+
+/**
+ * @brief Stop a timer. An already signaled timeout that is still queued
+ *        is discarded by fsmDispatch().
+ *
+ * @param timer - timer
+ */
+void fsmTimerStop(FsmTimer_t* timer)
+{
+    if (NULL != timer->pprev)
+    {
+        fsmTimerUnlink(timer);
+    }
+    timer->expired = 0;
+}
+
+/**
+ * @brief Attach a timer to a fsm instance to enable state timeouts.
+ *        Every instance needs its own timer. If the current state has a
+ *        timeout, the timer is started. Should be called after fsmInit().
+ *        Without FSM_TIMER the call has no effect.
+ *
+ * @param fsmHandle - fsm instance
+ * @param timer - timer of the instance
+ * @param wheel - timer wheel that drives the timer
+ */
+void fsmAttachTimer(FsmHandle_t* fsmHandle, FsmTimer_t* timer, FsmTimerWheel_t* wheel)
+{
+#if (FSM_TIMER != 0)
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expiry = 0;
+    timer->wheel = wheel;
+    timer->fsmHandle = fsmHandle;
+    timer->expired = 0;
+
+    fsmHandle->timer = timer;
+
+    if (0 != fsmHandle->def->table[fsmHandle->currentState].timeout)
+    {
+        fsmTimerStart(timer, fsmHandle->def->table[fsmHandle->currentState].timeout);
+    }
+#else
+    (void)fsmHandle;
+    (void)timer;
+    (void)wheel;
+#endif
+}
@@ -0,0 +1,142 @@
+/********************************************************************************
+ * @file           : fsmTimer.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Hierarchical timer wheel for FSM state timeouts
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * One timer wheel is shared by all FSM instances. Every instance that
+ * uses state timeouts gets its own timer (attached with fsmAttachTimer()),
+ * which is armed automatically on entry of a state with a timeout and
+ * stopped when the state is left. When the timeout expires, FSM_EVENT_TIMEOUT
+ * is posted to the instance queue (or dispatched directly if the instance
+ * has no queue). The timer member of the instance is compiled in with
+ * FSM_TIMER = 1 (default 0), the queue with FSM_QUEUE = 1.
+ *
+ * The wheel has FSM_TIMER_NR_OF_LEVELS levels with FSM_TIMER_NR_OF_SLOTS
+ * slots each. Starting and stopping a timer is O(1), a tick only touches
+ * the slot of the current tick (plus a cascade of the next level every
+ * FSM_TIMER_NR_OF_SLOTS ticks), independent of the number of instances.
+ * Timeouts are limited to FSM_TIMER_MAX_TICKS.
+ *
+ * fsmTimerTick() and the FSM instances must be executed in the same context
+ * (e.g. main loop), the tick source (e.g. SysTick interrupt) only counts
+ * the elapsed ticks. Timeouts are posted with fsmPostMulti(), so the queue
+ * may also be filled from interrupts. If the queue is full, the timeout is
+ * posted again on the next tick.
+ *
+ * Example usage:
+ *
+ *     static const FsmStateDef_t modemFsmTable[] =
+ *     {
+ *         [MODEM_STATE_IDLE]    = { StateIdle,    NULL,          NULL, 0    },
+ *         [MODEM_STATE_WAIT_OK] = { StateWaitOk,  OnEntryWaitOk, NULL, 500U },
+ *     };
+ *
+ *     static uint8_t StateWaitOk(void* context, const FsmEvent_t event)
+ *     {
+ *         uint8_t nextState = MODEM_STATE_WAIT_OK;
+ *
+ *         if (FSM_EVENT_TIMEOUT == event)
+ *         {
+ *             nextState = MODEM_STATE_IDLE;
+ *         }
+ *
+ *         return nextState;
+ *     }
+ *
+ *     static FsmTimerWheel_t timerWheel;
+ *     static FsmTimer_t modemFsmTimer;
+ *
+ *     fsmTimerWheelInit(&timerWheel);
+ *     fsmInit(&modemFsm, &modemFsmDef, MODEM_STATE_IDLE, &modem);
+ *     fsmAttachTimer(&modemFsm, &modemFsmTimer, &timerWheel);
+ *
+ *     while (1)
+ *     {
+ *         fsmTimerAdvance(&timerWheel, sysTicksElapsed());
+ *         fsmProcess(&modemFsm);
+ *     }
+ *
+ * Every level has an occupancy bitmap of its slots, so the next expiry
+ * (fsmTimerNextExpiry(), e.g. to program a tickless idle wakeup) is found
+ * with a few bit scans instead of looking at every timer, and
+ * fsmTimerAdvance() skips the ticks without expiry or cascade after a
+ * long sleep.
+ *
+ ********************************************************************************/
+
+#ifndef FSM_TIMER_H
+#define FSM_TIMER_H
+
+#include "stdint.h"
+#include "fsm.h"
+
+#ifndef FSM_TIMER_NR_OF_LEVELS
+#define FSM_TIMER_NR_OF_LEVELS  4U
+#endif
+
+#ifndef FSM_TIMER_SLOT_BITS
+#define FSM_TIMER_SLOT_BITS  6U
+#endif
+
+#define FSM_TIMER_NR_OF_SLOTS  (1UL << FSM_TIMER_SLOT_BITS)
+#define FSM_TIMER_SLOT_MASK    (FSM_TIMER_NR_OF_SLOTS - 1UL)
+#define FSM_TIMER_MAX_TICKS    ((1UL << (FSM_TIMER_SLOT_BITS * FSM_TIMER_NR_OF_LEVELS)) - 1UL)
+
+/* Number of 32 bit words of the occupancy bitmap of one level. */
+#define FSM_TIMER_BITMAP_WORDS  ((FSM_TIMER_NR_OF_SLOTS + 31UL) / 32UL)
+
+typedef struct
+{
+    FsmTimer_t* slots[FSM_TIMER_NR_OF_LEVELS][FSM_TIMER_NR_OF_SLOTS];
+    uint32_t occupied[FSM_TIMER_NR_OF_LEVELS][FSM_TIMER_BITMAP_WORDS]; /* bit set if the slot holds a timer */
+    uint32_t now;
+} FsmTimerWheel_t;
+
+struct FsmTimer
+{
+    FsmTimer_t* next;
+    FsmTimer_t** pprev; /* NULL if the timer is not running */
+    uint32_t expiry;
+    FsmTimerWheel_t* wheel;
+    FsmHandle_t* fsmHandle;
+    volatile uint8_t expired;
+    uint16_t slot; /* level * FSM_TIMER_NR_OF_SLOTS + slot index while linked */
+};
+
+void fsmTimerWheelInit(FsmTimerWheel_t* wheel);
+void fsmTimerTick(FsmTimerWheel_t* wheel);
+void fsmTimerAdvance(FsmTimerWheel_t* wheel, uint32_t ticks);
+int8_t fsmTimerNextExpiry(const FsmTimerWheel_t* wheel, uint32_t* ticks);
+
+void fsmTimerStart(FsmTimer_t* timer, uint32_t ticks);
+void fsmTimerStop(FsmTimer_t* timer);
+
+void fsmAttachTimer(FsmHandle_t* fsmHandle, FsmTimer_t* timer, FsmTimerWheel_t* wheel);
+
+#endif /* FSM_TIMER_H */
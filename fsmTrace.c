@@ -0,0 +1,103 @@
+/********************************************************************************
+ * @file           : fsmTrace.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Binary transition trace of FSM instances
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmTrace.h"
+#include "stddef.h"
+
+FsmTrace_t* fsmTraceSink = NULL;
+
+/**
+ * @brief Initialize a trace ring buffer.
+ *
+ * @param trace - trace instance
+ * @param records - record array with size items
+ * @param size - number of records, power of two (2 - 32768)
+ * @return  0 - trace initialized
+ *         -1 - invalid record array or size
+ */
+int8_t fsmTraceInit(FsmTrace_t* trace, FsmTraceRecord_t* records, const uint16_t size)
+{
+    int8_t traceInitialized = -1;
+
+    if ((NULL != records) && (size >= 2) && (0 == (size & (size - 1))))
+    {
+        trace->records = records;
+        trace->mask = (uint32_t)size - 1;
+        atomic_init(&trace->writeIndex, 0);
+        traceInitialized = 0;
+    }
+    return traceInitialized;
+}
+
+/**
+ * @brief Set the trace that records the transitions of all fsm instances.
+ *
+ * @param trace - trace instance or NULL to stop tracing
+ */
+void fsmTraceSetSink(FsmTrace_t* trace)
+{
+    fsmTraceSink = trace;
+}
+
+/**
+ * @brief Write the trace in stream format, oldest record first.
+ *        Transitions that happen during the dump may overwrite records
+ *        that are not written yet, stop the fsm instances for a clean dump.
+ *
+ * @param trace - trace instance
+ * @param writeFunc - output function (e.g. UART, RTT)
+ */
+void fsmTraceDump(FsmTrace_t* trace, FsmTraceWriteFunc_t* writeFunc)
+{
+    uint32_t writeIndex = atomic_load_explicit(&trace->writeIndex, memory_order_acquire);
+    uint32_t size = trace->mask + 1;
+    uint32_t nrOfRecords = (writeIndex < size) ? writeIndex : size;
+    uint8_t header[12];
+
+    header[0] = (uint8_t)(FSM_TRACE_MAGIC);
+    header[1] = (uint8_t)(FSM_TRACE_MAGIC >> 8);
+    header[2] = (uint8_t)(FSM_TRACE_MAGIC >> 16);
+    header[3] = (uint8_t)(FSM_TRACE_MAGIC >> 24);
+    header[4] = (uint8_t)(FSM_TRACE_VERSION);
+    header[5] = (uint8_t)(FSM_TRACE_VERSION >> 8);
+    header[6] = (uint8_t)(sizeof(FsmTraceRecord_t));
+    header[7] = (uint8_t)(sizeof(FsmTraceRecord_t) >> 8);
+    header[8] = (uint8_t)(nrOfRecords);
+    header[9] = (uint8_t)(nrOfRecords >> 8);
+    header[10] = (uint8_t)(nrOfRecords >> 16);
+    header[11] = (uint8_t)(nrOfRecords >> 24);
+    writeFunc(header, sizeof(header));
+
+    for (uint32_t i = writeIndex - nrOfRecords; i != writeIndex; i++)
+    {
+        writeFunc((const uint8_t*)&trace->records[i & trace->mask], sizeof(FsmTraceRecord_t));
+    }
+}
@@ -0,0 +1,143 @@
+/********************************************************************************
+ * @file           : fsmTrace.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Binary transition trace of FSM instances
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Optional trace sink, compiled in with FSM_TRACE = 1 (default 0).
+ * Every transition of every instance writes one fixed size record
+ * (timestamp, instance id, from state, to state) to a preallocated ring
+ * buffer. Writing a record reserves a slot with one atomic increment, so it
+ * is lock-free and costs a handful of cycles per transition. Calls without
+ * transition do not touch the trace at all. The ring keeps the last
+ * transitions, older records are overwritten. The slot is reserved before
+ * the timestamp is read, so records of different writers (interrupts,
+ * threads) can be slightly out of timestamp order.
+ *
+ * The instance id is the id of the handle (set by fsmSchedAdd() or
+ * fsmSetId()). The timestamp is read with FSM_TRACE_TIMESTAMP(), by default
+ * it calls fsmTraceTimestamp(), which must be implemented by the application
+ * (e.g. return a tick counter or DWT->CYCCNT).
+ *
+ * fsmTraceDump() writes the trace in a binary stream format (e.g. over UART
+ * or RTT) that is decoded by tools/fsmTraceDecode.py into a timeline.
+ * From a core dump, the record array and the write index can be decoded
+ * the same way (see the tool help).
+ *
+ * Stream format (little endian, records are written as in memory, so the
+ * target must be little endian too):
+ *     header:  uint32 magic FSM_TRACE_MAGIC, uint16 version, uint16 record size,
+ *              uint32 number of records that follow
+ *     records: oldest first, FsmTraceRecord_t
+ *
+ * Example usage:
+ *
+ *     static FsmTraceRecord_t traceRecords[256];
+ *     static FsmTrace_t trace;
+ *
+ *     fsmTraceInit(&trace, traceRecords, 256);
+ *     fsmTraceSetSink(&trace);
+ *
+ *     ...
+ *
+ *     fsmTraceDump(&trace, uartWrite);
+ *
+ * Host side:
+ *
+ *     python3 tools/fsmTraceDecode.py trace.bin --states protoStates.txt
+ *
+ ********************************************************************************/
+
+#ifndef FSM_TRACE_H
+#define FSM_TRACE_H
+
+#include "stdint.h"
+#include "stddef.h"
+#ifndef __cplusplus
+#include "stdatomic.h"
+#endif
+#include "fsm.h"
+
+#define FSM_TRACE_MAGIC    0x544D5346UL /* "FSMT" */
+#define FSM_TRACE_VERSION  (uint16_t)1U
+
+#ifndef FSM_TRACE_TIMESTAMP
+uint32_t fsmTraceTimestamp(void);
+#define FSM_TRACE_TIMESTAMP()  fsmTraceTimestamp()
+#endif
+
+typedef struct
+{
+    uint32_t timestamp;
+    uint16_t id;
+    uint8_t from;
+    uint8_t to;
+} FsmTraceRecord_t;
+
+typedef struct
+{
+    FsmTraceRecord_t* records;
+    uint32_t mask;
+    FSM_ATOMIC(uint32_t) writeIndex; /* total number of records written */
+} FsmTrace_t;
+
+typedef void FsmTraceWriteFunc_t(const uint8_t* data, const uint16_t length);
+
+extern FsmTrace_t* fsmTraceSink;
+
+int8_t fsmTraceInit(FsmTrace_t* trace, FsmTraceRecord_t* records, const uint16_t size);
+void fsmTraceSetSink(FsmTrace_t* trace);
+void fsmTraceDump(FsmTrace_t* trace, FsmTraceWriteFunc_t* writeFunc);
+
+#ifndef __cplusplus
+/**
+ * @brief Write a transition record to the trace sink (used by fsmDispatch(),
+ *        not available in C++).
+ *
+ * @param id - instance id
+ * @param from - state that was left
+ * @param to - state that was entered
+ */
+static inline void fsmTraceTransition(const uint16_t id, const uint8_t from, const uint8_t to)
+{
+    FsmTrace_t* trace = fsmTraceSink;
+
+    if (NULL != trace)
+    {
+        uint32_t index = atomic_fetch_add_explicit(&trace->writeIndex, 1, memory_order_relaxed);
+        FsmTraceRecord_t* record = &trace->records[index & trace->mask];
+
+        record->timestamp = FSM_TRACE_TIMESTAMP();
+        record->id = id;
+        record->from = from;
+        record->to = to;
+    }
+}
+#endif
+
+#endif /* FSM_TRACE_H */
@@ -0,0 +1,566 @@
+/********************************************************************************
+ * @file           : fsmCheck.c
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Parallel model checker for FSM definitions
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************/
+
+#include "fsmCheck.h"
+#include "stdatomic.h"
+#include "stddef.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "pthread.h"
+
+/* At least this many product states stay on a worker stack when it shares work. */
+#define FSM_CHECK_SHARE_MIN  64U
+
+/*
+ * Product state index p = context * nrOfStates + state, bit p of the
+ * visited bitmap is set by the worker that reaches it first, only that
+ * worker explores it. Every worker explores depth first from its own
+ * stack and hands half of it to the shared pool if another worker is idle.
+ */
+
+typedef struct
+{
+    uint64_t* items;
+    size_t count;
+    size_t size;
+} FsmCheckStack_t;
+
+typedef struct
+{
+    const FsmCheckModel_t* model;
+    FsmDef_t def;                /* copy of the model definition with the error function of the checker */
+    _Atomic uint32_t* visited;
+    FsmCheckResult_t* result;
+    pthread_mutex_t lock;        /* pool, idle workers, done, stored issues */
+    pthread_cond_t wake;
+    FsmCheckStack_t pool;
+    _Atomic uint16_t idle;
+    uint16_t nrOfThreads;
+    uint8_t done;
+    _Atomic uint8_t failed;      /* out of memory */
+} FsmCheck_t;
+
+typedef struct
+{
+    FsmCheck_t* check;
+    FsmCheckStack_t stack;
+    uint8_t* context;            /* private context of the worker, NULL for context free machines */
+    uint64_t productStates;
+    uint64_t steps;
+    uint64_t counts[FSM_CHECK_OUT_OF_RANGE + 1];
+    uint32_t reached[FSM_STATE_MASK_WORDS(256)];
+    pthread_t thread;
+} FsmCheckWorker_t;
+
+/* invalid next state of the running dispatch, set by the error function */
+static _Thread_local uint8_t fsmCheckInvalid;
+static _Thread_local uint8_t fsmCheckInvalidState;
+
+/**
+ * @brief Error function of the checked definition, records the invalid
+ *        next state and keeps the current state.
+ *
+ * @param context - context of the instance
+ * @param state - current state
+ * @param invalidState - invalid next state
+ * @return current state
+ */
+static uint8_t fsmCheckErrorFunc(void* context, const uint8_t state, const uint8_t invalidState)
+{
+    (void)context;
+
+    fsmCheckInvalid = 1;
+    fsmCheckInvalidState = invalidState;
+    return state;
+}
+
+/**
+ * @brief Push a product state to a stack, the stack grows as needed.
+ *
+ * @param stack - stack
+ * @param product - product state index
+ * @return  0 - pushed
+ *         -1 - out of memory
+ */
+static int8_t fsmCheckPush(FsmCheckStack_t* stack, const uint64_t product)
+{
+    int8_t pushed = 0;
+
+    if (stack->count == stack->size)
+    {
+        size_t size = (0 != stack->size) ? (stack->size * 2U) : 1024U;
+        uint64_t* items = realloc(stack->items, size * sizeof(uint64_t));
+
+        if (NULL != items)
+        {
+            stack->items = items;
+            stack->size = size;
+        }
+        else
+        {
+            pushed = -1;
+        }
+    }
+
+    if (0 == pushed)
+    {
+        stack->items[stack->count] = product;
+        stack->count++;
+    }
+    return pushed;
+}
+
+/**
+ * @brief Mark a product state visited.
+ *
+ * @param visited - visited bitmap
+ * @param product - product state index
+ * @return 1 - product state was not visited before
+ *         0 - product state was already visited
+ */
+static inline uint8_t fsmCheckVisit(_Atomic uint32_t* visited, const uint64_t product)
+{
+    uint32_t bit = 1UL << (product & 31U);
+
+    return (0 == (atomic_fetch_or_explicit(&visited[product >> 5], bit, memory_order_relaxed) & bit)) ? 1 : 0;
+}
+
+/**
+ * @brief Stop all workers because of a fatal error.
+ *
+ * @param check - checker instance
+ */
+static void fsmCheckFail(FsmCheck_t* check)
+{
+    pthread_mutex_lock(&check->lock);
+    atomic_store(&check->failed, 1);
+    check->done = 1;
+    pthread_cond_broadcast(&check->wake);
+    pthread_mutex_unlock(&check->lock);
+}
+
+/**
+ * @brief Count an issue and store its details if there is space left.
+ *
+ * @param worker - worker that found the issue
+ * @param type - issue type
+ * @param state - state of the product state
+ * @param event - dispatched event
+ * @param nextState - next state
+ * @param context - context index of the product state
+ */
+static void fsmCheckIssue(FsmCheckWorker_t* worker, const FsmCheckIssueType_t type, const uint8_t state,
+                          const FsmEvent_t event, const uint8_t nextState, const uint32_t context)
+{
+    FsmCheck_t* check = worker->check;
+
+    worker->counts[type]++;
+
+    pthread_mutex_lock(&check->lock);
+    if (check->result->nrOfStoredIssues < FSM_CHECK_MAX_ISSUES)
+    {
+        FsmCheckIssue_t* issue = &check->result->issues[check->result->nrOfStoredIssues];
+
+        issue->type = type;
+        issue->state = state;
+        issue->event = event;
+        issue->nextState = nextState;
+        issue->context = context;
+        check->result->nrOfStoredIssues++;
+    }
+    pthread_mutex_unlock(&check->lock);
+}
+
+/**
+ * @brief Dispatch every event of the model in a product state and push the
+ *        product states that were not visited yet.
+ *
+ * @param worker - worker
+ * @param product - product state index
+ */
+static void fsmCheckExpand(FsmCheckWorker_t* worker, const uint64_t product)
+{
+    FsmCheck_t* check = worker->check;
+    const FsmCheckModel_t* model = check->model;
+    uint8_t nrOfStates = check->def.nrOfStates;
+    uint8_t state = (uint8_t)(product % nrOfStates);
+    uint32_t context = (uint32_t)(product / nrOfStates);
+    uint8_t left = 0;
+
+    worker->reached[state >> 5] |= 1UL << (state & 31U);
+
+    for (uint8_t i = 0; (i < model->nrOfEvents) && (0 == atomic_load_explicit(&check->failed, memory_order_relaxed)); i++)
+    {
+        FsmHandle_t fsmHandle;
+        uint32_t contextNext = 0;
+
+        if (NULL != model->decode)
+        {
+            model->decode(context, worker->context);
+        }
+        (void)fsmInit(&fsmHandle, &check->def, state, worker->context);
+
+        fsmCheckInvalid = 0;
+        fsmDispatch(&fsmHandle, model->events[i]);
+        worker->steps++;
+
+        if (0 != fsmCheckInvalid)
+        {
+            fsmCheckIssue(worker, FSM_CHECK_INVALID_NEXT, state, model->events[i], fsmCheckInvalidState, context);
+        }
+
+        if (NULL != model->encode)
+        {
+            contextNext = model->encode(worker->context);
+        }
+
+        if (contextNext >= model->nrOfContexts)
+        {
+            fsmCheckIssue(worker, FSM_CHECK_OUT_OF_RANGE, state, model->events[i], fsmHandle.currentState, context);
+        }
+        else
+        {
+            uint64_t productNext = ((uint64_t)contextNext * nrOfStates) + fsmHandle.currentState;
+
+            if (productNext != product)
+            {
+                left = 1;
+            }
+            if ((0 != fsmCheckVisit(check->visited, productNext)) && (0 != fsmCheckPush(&worker->stack, productNext)))
+            {
+                fsmCheckFail(check);
+            }
+        }
+    }
+
+    if ((0 == left) && ((NULL == model->finalMask) || (0 == (model->finalMask[state >> 5] & (1UL << (state & 31U))))))
+    {
+        fsmCheckIssue(worker, FSM_CHECK_DEADLOCK, state, 0, state, context);
+    }
+}
+
+/**
+ * @brief Hand the older half of the worker stack to the shared pool if
+ *        another worker is idle.
+ *
+ * @param worker - worker
+ */
+static void fsmCheckShare(FsmCheckWorker_t* worker)
+{
+    FsmCheck_t* check = worker->check;
+
+    if ((0 != atomic_load_explicit(&check->idle, memory_order_relaxed)) && (worker->stack.count >= (2U * FSM_CHECK_SHARE_MIN)))
+    {
+        size_t half = worker->stack.count / 2U;
+
+        pthread_mutex_lock(&check->lock);
+        for (size_t i = 0; (i < half) && (0 == atomic_load(&check->failed)); i++)
+        {
+            if (0 != fsmCheckPush(&check->pool, worker->stack.items[i]))
+            {
+                atomic_store(&check->failed, 1);
+                check->done = 1;
+            }
+        }
+        pthread_cond_broadcast(&check->wake);
+        pthread_mutex_unlock(&check->lock);
+
+        memmove(worker->stack.items, &worker->stack.items[half], (worker->stack.count - half) * sizeof(uint64_t));
+        worker->stack.count -= half;
+    }
+}
+
+/**
+ * @brief Take work from the shared pool, wait if it is empty. The check is
+ *        done when all workers wait and the pool is empty.
+ *
+ * @param worker - worker
+ * @return 1 - work taken
+ *         0 - check done
+ */
+static uint8_t fsmCheckFetch(FsmCheckWorker_t* worker)
+{
+    FsmCheck_t* check = worker->check;
+    uint8_t fetched = 0;
+
+    pthread_mutex_lock(&check->lock);
+    while ((0 == check->pool.count) && (0 == check->done))
+    {
+        if ((atomic_fetch_add(&check->idle, 1) + 1U) == check->nrOfThreads)
+        {
+            check->done = 1;
+            pthread_cond_broadcast(&check->wake);
+        }
+        else
+        {
+            pthread_cond_wait(&check->wake, &check->lock);
+        }
+        atomic_fetch_sub(&check->idle, 1);
+    }
+
+    if ((0 == check->done) || (0 != check->pool.count))
+    {
+        size_t take = (check->pool.count + check->nrOfThreads - 1U) / check->nrOfThreads;
+
+        while ((take > 0) && (0 == fsmCheckPush(&worker->stack, check->pool.items[check->pool.count - 1U])))
+        {
+            check->pool.count--;
+            take--;
+        }
+        fetched = (worker->stack.count > 0) ? 1 : 0;
+    }
+    pthread_mutex_unlock(&check->lock);
+
+    if ((0 == fetched) && (0 == check->done))
+    {
+        fsmCheckFail(check);
+    }
+    return fetched;
+}
+
+/**
+ * @brief Worker thread: explore until the check is done.
+ *
+ * @param arg - worker
+ * @return NULL
+ */
+static void* fsmCheckWorker(void* arg)
+{
+    FsmCheckWorker_t* worker = arg;
+    FsmCheck_t* check = worker->check;
+
+    while ((0 == atomic_load(&check->failed)) && (0 != fsmCheckFetch(worker)))
+    {
+        while ((worker->stack.count > 0) && (0 == atomic_load_explicit(&check->failed, memory_order_relaxed)))
+        {
+            worker->stack.count--;
+            worker->productStates++;
+            fsmCheckExpand(worker, worker->stack.items[worker->stack.count]);
+            fsmCheckShare(worker);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Check if a state is the parent of another state (never the
+ *        current state of a hierarchical fsm).
+ *
+ * @param fsmDef - fsm definition
+ * @param state - state to check
+ * @return 1 - state is a parent
+ *         0 - state is no parent
+ */
+static uint8_t fsmCheckIsParent(const FsmDef_t* fsmDef, const uint8_t state)
+{
+    uint8_t isParent = 0;
+
+    for (uint16_t i = 0; (NULL != fsmDef->parents) && (i < fsmDef->nrOfStates) && (0 == isParent); i++)
+    {
+        isParent = (fsmDef->parents[i] == state) ? 1 : 0;
+    }
+    return isParent;
+}
+
+/**
+ * @brief Explore all reachable product states of a model.
+ *
+ * @param model - model to check
+ * @param nrOfThreads - number of worker threads (1 - FSM_CHECK_MAX_NR_OF_THREADS)
+ * @param result - [out] statistics and issues
+ * @return  0 - model checked, see result->nrOfIssues
+ *         -1 - invalid model, out of memory or threads could not be created
+ */
+int8_t fsmCheckRun(const FsmCheckModel_t* model, const uint16_t nrOfThreads, FsmCheckResult_t* result)
+{
+    int8_t checked = -1;
+    uint8_t valid;
+
+    memset(result, 0, sizeof(*result));
+
+    valid = ((NULL != model->def) && (NULL != model->events) && (nrOfThreads != 0) && (nrOfThreads <= FSM_CHECK_MAX_NR_OF_THREADS) &&
+             (0 != model->def->nrOfStates) && (0 != model->nrOfEvents) && (model->initState < model->def->nrOfStates) &&
+             (0 != model->nrOfContexts) && (model->initContext < model->nrOfContexts) &&
+             ((model->nrOfContexts <= 1U) || (NULL != model->encode)) && ((0 == model->contextSize) || (NULL != model->decode))) ? 1 : 0;
+
+    if (0 != valid)
+    {
+        FsmCheckWorker_t* workers;
+        FsmCheck_t check;
+        uint64_t nrOfProducts;
+        uint64_t initProduct;
+        uint16_t nrOfStarted = 0;
+
+        nrOfProducts = (uint64_t)model->nrOfContexts * model->def->nrOfStates;
+        initProduct = ((uint64_t)model->initContext * model->def->nrOfStates) + model->initState;
+        workers = calloc(nrOfThreads, sizeof(FsmCheckWorker_t));
+        check.model = model;
+        check.def = *model->def;
+        check.def.errorFunc = fsmCheckErrorFunc;
+        check.result = result;
+        check.visited = calloc((size_t)((nrOfProducts + 31U) / 32U), sizeof(uint32_t));
+        check.pool.items = NULL;
+        check.pool.count = 0;
+        check.pool.size = 0;
+        atomic_init(&check.idle, 0);
+        check.nrOfThreads = nrOfThreads;
+        check.done = 0;
+        atomic_init(&check.failed, 0);
+        pthread_mutex_init(&check.lock, NULL);
+        pthread_cond_init(&check.wake, NULL);
+
+        if ((NULL != workers) && (NULL != check.visited) && (0 == fsmCheckPush(&check.pool, initProduct)))
+        {
+            (void)fsmCheckVisit(check.visited, initProduct);
+
+            for (uint16_t i = 0; i < nrOfThreads; i++)
+            {
+                FsmCheckWorker_t* worker = &workers[i];
+
+                worker->check = &check;
+                worker->context = (0 != model->contextSize) ? malloc(model->contextSize) : NULL;
+
+                if (((0 != model->contextSize) && (NULL == worker->context)) ||
+                    (0 != pthread_create(&worker->thread, NULL, fsmCheckWorker, worker)))
+                {
+                    free(worker->context);
+                    fsmCheckFail(&check);
+                    break;
+                }
+                nrOfStarted++;
+            }
+
+            /* a worker that was not started counts as idle, so the others can finish */
+            pthread_mutex_lock(&check.lock);
+            atomic_fetch_add(&check.idle, (uint16_t)(nrOfThreads - nrOfStarted));
+            pthread_mutex_unlock(&check.lock);
+
+            for (uint16_t i = 0; i < nrOfStarted; i++)
+            {
+                FsmCheckWorker_t* worker = &workers[i];
+
+                pthread_join(worker->thread, NULL);
+                result->productStates += worker->productStates;
+                result->steps += worker->steps;
+                for (uint8_t type = 0; type <= FSM_CHECK_OUT_OF_RANGE; type++)
+                {
+                    result->counts[type] += worker->counts[type];
+                }
+                for (uint8_t word = 0; word < FSM_STATE_MASK_WORDS(256); word++)
+                {
+                    result->reached[word] |= worker->reached[word];
+                }
+                free(worker->stack.items);
+                free(worker->context);
+            }
+
+            if ((0 == atomic_load(&check.failed)) && (nrOfStarted == nrOfThreads))
+            {
+                for (uint16_t state = 0; state < model->def->nrOfStates; state++)
+                {
+                    if ((0 == (result->reached[state >> 5] & (1UL << (state & 31U)))) &&
+                        (0 == fsmCheckIsParent(model->def, (uint8_t)state)))
+                    {
+                        result->counts[FSM_CHECK_UNREACHABLE]++;
+                        if (result->nrOfStoredIssues < FSM_CHECK_MAX_ISSUES)
+                        {
+                            FsmCheckIssue_t* issue = &result->issues[result->nrOfStoredIssues];
+
+                            issue->type = FSM_CHECK_UNREACHABLE;
+                            issue->state = (uint8_t)state;
+                            issue->event = 0;
+                            issue->nextState = (uint8_t)state;
+                            issue->context = 0;
+                            result->nrOfStoredIssues++;
+                        }
+                    }
+                }
+
+                for (uint8_t type = 0; type <= FSM_CHECK_OUT_OF_RANGE; type++)
+                {
+                    result->nrOfIssues += result->counts[type];
+                }
+                checked = 0;
+            }
+        }
+
+        pthread_cond_destroy(&check.wake);
+        pthread_mutex_destroy(&check.lock);
+        free(check.pool.items);
+        free((void*)check.visited);
+        free(workers);
+    }
+    return checked;
+}
+
+/**
+ * @brief Print the result of a check.
+ *
+ * @param model - checked model
+ * @param result - result of fsmCheckRun()
+ */
+void fsmCheckPrint(const FsmCheckModel_t* model, const FsmCheckResult_t* result)
+{
+    static const char* const names[] = { "unreachable state", "deadlock", "invalid next state", "context out of model" };
+
+    printf("%llu product states (%u states x %lu contexts), %llu steps, %llu issues\n",
+           (unsigned long long)result->productStates, (unsigned)model->def->nrOfStates,
+           (unsigned long)model->nrOfContexts, (unsigned long long)result->steps,
+           (unsigned long long)result->nrOfIssues);
+
+    for (uint8_t type = 0; type <= FSM_CHECK_OUT_OF_RANGE; type++)
+    {
+        if (0 != result->counts[type])
+        {
+            printf("  %-22s %llu\n", names[type], (unsigned long long)result->counts[type]);
+        }
+    }
+
+    for (uint16_t i = 0; i < result->nrOfStoredIssues; i++)
+    {
+        const FsmCheckIssue_t* issue = &result->issues[i];
+
+        switch (issue->type)
+        {
+            case FSM_CHECK_UNREACHABLE:
+                printf("  %s: state %u\n", names[issue->type], (unsigned)issue->state);
+                break;
+            case FSM_CHECK_DEADLOCK:
+                printf("  %s: state %u, context %lu\n", names[issue->type], (unsigned)issue->state, (unsigned long)issue->context);
+                break;
+            default:
+                printf("  %s: state %u, context %lu, event %u -> %u\n", names[issue->type], (unsigned)issue->state,
+                       (unsigned long)issue->context, (unsigned)issue->event, (unsigned)issue->nextState);
+                break;
+        }
+    }
+}
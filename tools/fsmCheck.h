@@ -0,0 +1,155 @@
+/********************************************************************************
+ * @file           : fsmCheck.h
+ * @author         : Christian Mahlburg
+ * @date           : 14.10.2026
+ * @brief          : Parallel model checker for FSM definitions
+ *
+ ********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2026 CMA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ********************************************************************************
+ *
+ * Host side model checker for fsm definitions (POSIX threads, not for the
+ * target). It explores every reachable product state (fsm state plus the
+ * context of the instance) under every event, in parallel on several
+ * threads, with one bit per product state as visited set, and reports:
+ *   - unreachable states (never the current state)
+ *   - deadlocks: product states that no event leaves (except final states)
+ *   - invalid transitions: next states that are out of range or not
+ *     registered (the cases fsmRun() only routes to the error function)
+ *   - contexts that leave the model (the encode function rejects them)
+ *
+ * The context is part of the model: the encode function maps a context to
+ * an index 0 - nrOfContexts - 1 and the decode function builds the context
+ * of an index, e.g. by packing the counters and flags of the context into
+ * bit fields. Context free machines use nrOfContexts = 1 and NULL functions.
+ * State, entry and exit functions and actions must only depend on the
+ * context and the event (stub hardware access in the model build).
+ * Every (product state, event) pair runs fsmDispatch() on a private copy of
+ * the context; state timeouts are checked by listing FSM_EVENT_TIMEOUT in
+ * the events. The definition is copied, its error function is replaced by
+ * the checker, so fsm.c must be built with FSM_CHECK_NEXT_STATE = 1.
+ *
+ * Build, e.g. as test that runs on every commit:
+ *
+ *     gcc -O2 -pthread -I. tools/fsmCheck.c fsm.c protoModel.c -o protoCheck
+ *
+ * Example usage:
+ *
+ *     static uint32_t ProtoEncode(const void* context)
+ *     {
+ *         const Proto_t* proto = context;
+ *
+ *         return (proto->retries <= 3U) ? ((uint32_t)proto->retries << 1) | proto->connected : FSM_CHECK_OUT_OF_MODEL;
+ *     }
+ *
+ *     static void ProtoDecode(const uint32_t index, void* context)
+ *     {
+ *         Proto_t* proto = context;
+ *
+ *         memset(proto, 0, sizeof(*proto));
+ *         proto->connected = index & 1U;
+ *         proto->retries = (uint8_t)(index >> 1);
+ *     }
+ *
+ *     static const FsmEvent_t protoEvents[] = { FSM_EVENT_TICK, FSM_EVENT_TIMEOUT, EVENT_RX, EVENT_TX };
+ *
+ *     FsmCheckModel_t model =
+ *     {
+ *         &protoFsmDef, protoEvents, sizeof(protoEvents) / sizeof(protoEvents[0]), PROTO_STATE_IDLE,
+ *         sizeof(Proto_t), 8U, 0U, ProtoEncode, ProtoDecode, NULL
+ *     };
+ *     static FsmCheckResult_t result;
+ *
+ *     fsmCheckRun(&model, 8, &result);
+ *     fsmCheckPrint(&model, &result);
+ *     return (0 == result.nrOfIssues) ? 0 : 1;
+ *
+ *
+ ********************************************************************************/
+
+#ifndef FSM_CHECK_H
+#define FSM_CHECK_H
+
+#include "stdint.h"
+#include "fsm.h"
+
+/* Returned by the encode function for a context that is not part of the model. */
+#define FSM_CHECK_OUT_OF_MODEL  UINT32_MAX
+
+/* Max number of issues that are stored with details, all are counted. */
+#ifndef FSM_CHECK_MAX_ISSUES
+#define FSM_CHECK_MAX_ISSUES  64U
+#endif
+
+#define FSM_CHECK_MAX_NR_OF_THREADS  64U
+
+typedef uint32_t FsmCheckEncodeFunc_t(const void* context);
+typedef void FsmCheckDecodeFunc_t(const uint32_t index, void* context);
+
+typedef struct
+{
+    const FsmDef_t* def;
+    const FsmEvent_t* events;  /* events dispatched in every product state */
+    uint8_t nrOfEvents;
+    uint8_t initState;
+    uint16_t contextSize;      /* bytes of the context, 0 for context free machines */
+    uint32_t nrOfContexts;     /* number of context indices, 1 for context free machines */
+    uint32_t initContext;      /* context index of the init state */
+    FsmCheckEncodeFunc_t* encode;
+    FsmCheckDecodeFunc_t* decode;
+    const uint32_t* finalMask; /* bit per state (FSM_STATE_MASK_WORDS(nrOfStates) words) that may have no successor, may be NULL */
+} FsmCheckModel_t;
+
+typedef enum
+{
+    FSM_CHECK_UNREACHABLE,  /* state is never the current state */
+    FSM_CHECK_DEADLOCK,     /* no event leaves the product state */
+    FSM_CHECK_INVALID_NEXT, /* state function returned an invalid next state */
+    FSM_CHECK_OUT_OF_RANGE, /* context after the event is not part of the model */
+} FsmCheckIssueType_t;
+
+typedef struct
+{
+    FsmCheckIssueType_t type;
+    uint8_t state;
+    FsmEvent_t event;     /* not used for unreachable states and deadlocks */
+    uint8_t nextState;    /* invalid next state (FSM_CHECK_INVALID_NEXT) */
+    uint32_t context;     /* context index of the product state */
+} FsmCheckIssue_t;
+
+typedef struct
+{
+    uint64_t productStates; /* reachable product states */
+    uint64_t steps;         /* dispatched (product state, event) pairs */
+    uint64_t nrOfIssues;
+    uint64_t counts[FSM_CHECK_OUT_OF_RANGE + 1]; /* issues per type */
+    uint32_t reached[FSM_STATE_MASK_WORDS(256)]; /* bit per state that was the current state */
+    FsmCheckIssue_t issues[FSM_CHECK_MAX_ISSUES];
+    uint16_t nrOfStoredIssues;
+} FsmCheckResult_t;
+
+int8_t fsmCheckRun(const FsmCheckModel_t* model, const uint16_t nrOfThreads, FsmCheckResult_t* result);
+void fsmCheckPrint(const FsmCheckModel_t* model, const FsmCheckResult_t* result);
+
+#endif /* FSM_CHECK_H */
@@ -0,0 +1,609 @@
+#!/usr/bin/env python3
+"""
+Generate a constant FSM definition (see fsm.h) from a state diagram.
+
+Input is a mermaid diagram (graph / flowchart / stateDiagram), a PlantUML
+state diagram or a SCXML subset. The machine is validated (unknown states,
+unreachable states, dead states, shadowed transitions, hierarchy depth)
+and written as <output>.h / <output>.c with the states and events as enums
+and the state table, transition table, transition index and hierarchy
+as const arrays, so no fsmDefInit() / fsmAdd() calls are
+needed at boot and the definition is placed in flash by the linker.
+
+Usage:
+    fsmGen.py button.mmd --name button -o buttonFsm
+    fsmGen.py conn.puml --name conn -o connFsm --hot Established,Closing
+    fsmGen.py proto.scxml --name proto -o protoFsm --switch
+
+Transition labels have the form "EVENT [guard] / action", every part is
+optional. A transition without event is taken on FSM_EVENT_TICK (like a
+state function that returns the next state on the polling call), the
+events TICK and TIMEOUT are the fsm module events, all others are numbered
+from FSM_EVENT_USER. Guards and actions are C function names
+(FsmGuardFunc_t / FsmActionFunc_t) that are declared in the header.
+
+Entry and exit functions, state timeouts and cycle budgets (FSM_STATE_BUDGET(),
+only used with FSM_PROFILING) are given per state:
+    PlantUML, mermaid stateDiagram:  A : entry / onEntryA
+                                     A : exit / onExitA
+                                     A : timeout / 100
+                                     A : budget / 2000
+    mermaid graph:                   %% A : entry / onEntryA
+    SCXML:                           <state id="A" fsm:entry="onEntryA" fsm:exit="onExitA" fsm:timeout="100" fsm:budget="2000">
+                                     <transition event="E" cond="guard" target="B" fsm:action="action"/>
+
+States are numbered in breadth-first order from the initial state, so
+states that follow each other are adjacent in the tables, --hot moves the
+given states to the front. --switch generates a state function with a
+switch over the events per state instead of the transition table (actions
+are called before the exit function then).
+
+MIT License, Copyright (c) 2026 CMA
+"""
+
+import argparse
+import collections
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+FSM_UNHANDLED = 0xFF
+FSM_MAX_DEPTH = 8
+MODULE_EVENTS = {"TICK": "FSM_EVENT_TICK", "TIMEOUT": "FSM_EVENT_TIMEOUT"}
+IDENTIFIER = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+
+
+class FsmError(Exception):
+    pass
+
+
+class State:
+    def __init__(self, name):
+        self.name = name
+        self.parent = None
+        self.entry = None
+        self.exit = None
+        self.timeout = 0
+        self.budget = 0
+        self.final = False
+        self.index = None
+
+
+class Transition:
+    def __init__(self, state, event, next_state, guard, action, line):
+        self.state = state
+        self.event = event
+        self.next_state = next_state
+        self.guard = guard
+        self.action = action
+        self.line = line
+
+
+class Machine:
+    def __init__(self):
+        self.states = collections.OrderedDict()
+        self.transitions = []
+        self.initial = None
+
+    def state(self, name):
+        if name not in self.states:
+            self.states[name] = State(name)
+        return self.states[name]
+
+
+def check_identifier(name, what, line):
+    if (name is not None) and (not IDENTIFIER.match(name)):
+        raise FsmError("line %d: %s '%s' is not a C identifier" % (line, what, name))
+    return name
+
+
+def parse_label(label, line):
+    """Split "EVENT [guard] / action" into its parts."""
+    match = re.match(r"^\s*([^\[/]*?)\s*(?:\[\s*([^\]]*?)\s*\])?\s*(?:/\s*(.*?))?\s*$", label or "")
+    if match is None:
+        raise FsmError("line %d: invalid transition label '%s'" % (line, label))
+    event = re.sub(r"[^A-Za-z0-9]+", "_", match.group(1)).strip("_").upper() or None
+    guard = check_identifier(match.group(2) or None, "guard", line)
+    action = check_identifier(match.group(3) or None, "action", line)
+    return event, guard, action
+
+
+def add_state_property(machine, name, text, line):
+    """Handle "A : entry / fn", "A : exit / fn", "A : timeout / 100" and "A : budget / 2000"."""
+    match = re.match(r"^\s*(entry|exit|timeout|budget)\s*/\s*(\S+)\s*$", text)
+    if match is not None:
+        state = machine.state(name)
+        if match.group(1) in ("timeout", "budget"):
+            try:
+                setattr(state, match.group(1), int(match.group(2), 0))
+            except ValueError:
+                raise FsmError("line %d: invalid %s '%s'" % (line, match.group(1), match.group(2)))
+        else:
+            setattr(state, match.group(1), check_identifier(match.group(2), match.group(1) + " function", line))
+    # other text is a state description
+
+
+def parse_text(text):
+    """Parse a mermaid or PlantUML diagram."""
+    machine = Machine()
+    stack = []
+    node = r"(\[\*\]|[A-Za-z_][A-Za-z0-9_]*)(?:\s*[\[\(\{]+[^\]\)\}]*[\]\)\}]+)?"
+    edges = [
+        re.compile(r"^" + node + r"\s*--+\s*([^->|][^>]*?)\s*--+>\s*" + node + r"\s*$"),     # A -- label --> B
+        re.compile(r"^" + node + r"\s*-+\.?-*>\s*\|([^|]*)\|\s*" + node + r"\s*$"),          # A -->|label| B
+        re.compile(r"^" + node + r"\s*-+(?:\[[^\]]*\]|left|right|up|down)?-*>\s*" + node + r"\s*(?::\s*(.*))?$"),  # A --> B : label
+    ]
+
+    def enter(name, line):
+        if "[*]" == name:
+            return None
+        check_identifier(name, "state", line)
+        if name not in machine.states:
+            # a state is a substate of the composite state it is first named in
+            machine.state(name).parent = stack[-1] if stack else None
+        return machine.states[name]
+
+    in_note = False
+    for line_nr, raw in enumerate(text.splitlines(), 1):
+        line = raw.strip().rstrip(";").strip()
+        if in_note:
+            in_note = not re.match(r"^end\s*note$", line)
+            continue
+        if re.match(r"^note\b", line) and (":" not in line):
+            in_note = True  # multi line PlantUML note
+            continue
+        mermaid_comment = line.startswith("%%")
+        if mermaid_comment:
+            line = line[2:].strip()
+        if (not line) or line.startswith("'") or line.startswith("@") or \
+                re.match(r"^(graph|flowchart|stateDiagram(-v2)?|direction|hide|skinparam|note|end note|title)\b", line):
+            continue
+
+        match = re.match(r"^state\s+(?:\"([^\"]*)\"\s+as\s+)?([A-Za-z_][A-Za-z0-9_]*)(?:\s*<<\w+>>)?\s*(\{)?\s*$", line)
+        if match is not None:
+            enter(match.group(2), line_nr)
+            if match.group(3):
+                stack.append(match.group(2))
+            continue
+        if "}" == line:
+            if not stack:
+                raise FsmError("line %d: unbalanced '}'" % line_nr)
+            stack.pop()
+            continue
+
+        for edge in edges:
+            match = edge.match(line)
+            if match is not None:
+                if edge is edges[2]:
+                    source, target, label = match.group(1), match.group(2), match.group(3)
+                else:
+                    source, label, target = match.group(1), match.group(2), match.group(3)
+                break
+        if match is not None:
+            state = enter(source, line_nr)
+            next_state = enter(target, line_nr)
+            if (state is None) and (next_state is not None):
+                if not stack:
+                    machine.initial = next_state.name  # initial states of composite states are not used
+            elif (state is not None) and (next_state is None):
+                state.final = True
+            elif state is not None:
+                event, guard, action = parse_label(label, line_nr)
+                machine.transitions.append(Transition(state.name, event, next_state.name, guard, action, line_nr))
+            continue
+
+        match = re.match(r"^([A-Za-z_][A-Za-z0-9_]*)\s*:\s*(.*)$", line)
+        if match is not None:
+            enter(match.group(1), line_nr)
+            add_state_property(machine, match.group(1), match.group(2), line_nr)
+            continue
+
+        match = re.match(r"^" + node + r"$", line)
+        if (match is not None) and ("[*]" != match.group(1)):
+            enter(match.group(1), line_nr)
+            continue
+
+        if not mermaid_comment:
+            raise FsmError("line %d: cannot parse '%s'" % (line_nr, raw.strip()))
+
+    if stack:
+        raise FsmError("state '%s' is not closed" % stack[-1])
+    if (machine.initial is None) and machine.states:
+        machine.initial = next(iter(machine.states))
+    return machine
+
+
+def parse_scxml(text):
+    """Parse the SCXML subset: state, parallel (as state), final, transition."""
+    machine = Machine()
+    try:
+        root = ET.fromstring(text)
+    except ET.ParseError as e:
+        raise FsmError("invalid SCXML: %s" % e)
+
+    def local(name):
+        return name.rsplit("}", 1)[-1]
+
+    def attribute(element, name):
+        for key, value in element.attrib.items():
+            if local(key) == name:
+                return value
+        return None
+
+    def walk(element, parent):
+        for child in element:
+            tag = local(child.tag)
+            if tag in ("state", "parallel", "final"):
+                name = check_identifier(attribute(child, "id"), "state", 0)
+                if name is None:
+                    raise FsmError("SCXML %s without id" % tag)
+                state = machine.state(name)
+                state.parent = parent
+                state.final = ("final" == tag)
+                state.entry = check_identifier(attribute(child, "entry"), "entry function", 0)
+                state.exit = check_identifier(attribute(child, "exit"), "exit function", 0)
+                state.timeout = int(attribute(child, "timeout") or "0", 0)
+                state.budget = int(attribute(child, "budget") or "0", 0)
+                walk(child, name)
+            elif ("transition" == tag) and (parent is not None):
+                targets = (attribute(child, "target") or "").split()
+                if len(targets) != 1:
+                    raise FsmError("state '%s': transitions need exactly one target" % parent)
+                event = attribute(child, "event")
+                event = re.sub(r"[^A-Za-z0-9]+", "_", event).strip("_").upper() if event else None
+                guard = check_identifier(attribute(child, "cond"), "guard", 0)
+                action = check_identifier(attribute(child, "action"), "action", 0)
+                machine.transitions.append(Transition(parent, event, targets[0], guard, action, 0))
+
+    walk(root, None)
+    initial = attribute(root, "initial")
+    machine.initial = initial.split()[0] if initial else (next(iter(machine.states)) if machine.states else None)
+    return machine
+
+
+def ancestors(machine, name):
+    chain = []
+    while name is not None:
+        chain.append(name)
+        name = machine.states[name].parent
+    return chain
+
+
+def validate(machine, allow_unreachable, allow_dead):
+    warnings = []
+    if not machine.states:
+        raise FsmError("no states")
+    if machine.initial not in machine.states:
+        raise FsmError("initial state '%s' is not defined" % machine.initial)
+    if len(machine.states) > 255:
+        raise FsmError("%d states, at most 255 are supported" % len(machine.states))
+
+    for transition in machine.transitions:
+        if transition.next_state not in machine.states:
+            raise FsmError("line %d: unknown state '%s'" % (transition.line, transition.next_state))
+
+    for name in machine.states:
+        if len(ancestors(machine, name)) > FSM_MAX_DEPTH:
+            raise FsmError("state '%s' is nested deeper than FSM_MAX_DEPTH (%d)" % (name, FSM_MAX_DEPTH))
+
+    # a transition after one with the same state, event and no guard is never taken
+    seen = {}
+    for transition in machine.transitions:
+        key = (transition.state, transition.event)
+        if key in seen:
+            raise FsmError("line %d: transition %s -> %s is shadowed by the transition in line %d" %
+                           (transition.line, transition.state, transition.next_state, seen[key]))
+        if transition.guard is None:
+            seen[key] = transition.line
+
+    outgoing = collections.defaultdict(list)
+    for transition in machine.transitions:
+        outgoing[transition.state].append(transition.next_state)
+
+    # a state receives the events of its parents, the parents are active as well
+    reachable = set()
+    pending = [machine.initial]
+    while pending:
+        name = pending.pop()
+        for state in ancestors(machine, name):
+            if state not in reachable:
+                reachable.add(state)
+                pending.append(state)
+            pending.extend(s for s in outgoing[state] if s not in reachable)
+
+    for name in machine.states:
+        if name not in reachable:
+            message = "state '%s' is not reachable from '%s'" % (name, machine.initial)
+            if not allow_unreachable:
+                raise FsmError(message)
+            warnings.append(message)
+        elif (not machine.states[name].final) and (not any(outgoing[s] for s in ancestors(machine, name))):
+            message = "state '%s' is a dead state (no transitions, not final)" % name
+            if not allow_dead:
+                raise FsmError(message)
+            warnings.append(message)
+    return warnings
+
+
+def number_states(machine, hot):
+    """Hot states first, then breadth-first from the initial state, then the rest."""
+    order = []
+    for name in hot:
+        if name not in machine.states:
+            raise FsmError("hot state '%s' is not defined" % name)
+        if name not in order:
+            order.append(name)
+
+    outgoing = collections.defaultdict(list)
+    for transition in machine.transitions:
+        outgoing[transition.state].append(transition.next_state)
+
+    visited = set(order)
+    queue = collections.deque([machine.initial])
+    while queue:
+        name = queue.popleft()
+        if name in visited:
+            continue
+        visited.add(name)
+        order.append(name)
+        queue.extend(outgoing[name])
+        queue.extend(ancestors(machine, name)[1:])
+    order.extend(name for name in machine.states if name not in visited)
+
+    for index, name in enumerate(order):
+        machine.states[name].index = index
+    return order
+
+
+def c_name(name):
+    """stateIdle -> IDLE, waitForAck -> WAIT_FOR_ACK"""
+    name = re.sub(r"^state(?=[A-Z0-9_])", "", name).strip("_")
+    return re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", name).upper()
+
+
+class Generator:
+    def __init__(self, machine, order, name, use_switch, source):
+        self.machine = machine
+        self.order = order
+        self.name = name
+        self.prefix = re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", name).upper()
+        self.use_switch = use_switch
+        self.source = source
+        self.hierarchy = any(s.parent is not None for s in machine.states.values())
+        self.events = []
+        for transition in machine.transitions:
+            event = transition.event or "TICK"
+            if (event not in MODULE_EVENTS) and (event not in self.events):
+                self.events.append(event)
+        if len(self.events) > 256 - 16:
+            raise FsmError("%d events, at most %d are supported" % (len(self.events), 256 - 16))
+        # transitions sorted by state (stable, the order of a state is kept)
+        self.transitions = sorted(machine.transitions, key=lambda t: machine.states[t.state].index)
+        self.by_state = collections.defaultdict(list)
+        for transition in self.transitions:
+            self.by_state[transition.state].append(transition)
+        # states without function and transitions are not valid next states (FSM_CHECK_NEXT_STATE)
+        self.unhandled = [n for n in order if (not self.by_state[n]) and
+                          (self.machine.states[n].entry is None) and (self.machine.states[n].exit is None)]
+
+    def state_enum(self, name):
+        return "%s_STATE_%s" % (self.prefix, c_name(name))
+
+    def event_enum(self, event):
+        event = event or "TICK"
+        return MODULE_EVENTS[event] if event in MODULE_EVENTS else "%s_EVENT_%s" % (self.prefix, event)
+
+    def state_func(self, name):
+        if self.use_switch and self.by_state[name]:
+            return "%sState%s" % (self.name, "".join(p.capitalize() for p in c_name(name).split("_")))
+        if name in self.unhandled:
+            return "%sStateUnhandled" % self.name
+        return None
+
+    def functions(self):
+        guards, actions, entries, exits = [], [], [], []
+        for transition in self.transitions:
+            if transition.guard and transition.guard not in guards:
+                guards.append(transition.guard)
+            if transition.action and transition.action not in actions:
+                actions.append(transition.action)
+        for name in self.order:
+            state = self.machine.states[name]
+            if state.entry and state.entry not in entries:
+                entries.append(state.entry)
+            if state.exit and state.exit not in exits:
+                exits.append(state.exit)
+        return guards, actions, entries, exits
+
+    def banner(self, file_name, brief):
+        return ("/********************************************************************************\n"
+                " * @file           : %s\n"
+                " * @brief          : %s\n"
+                " *                   Generated by tools/fsmGen.py from %s, do not edit.\n"
+                " *******************************************************************************/\n" %
+                (file_name, brief, os.path.basename(self.source)))
+
+    def header(self, base):
+        guard_macro = re.sub(r"[^A-Za-z0-9]", "_", os.path.basename(base)).upper() + "_H"
+        guards, actions, entries, exits = self.functions()
+        out = [self.banner(os.path.basename(base) + ".h", "%s state machine" % self.name)]
+        out.append("#ifndef %s\n#define %s\n\n#include \"fsm.h\"\n" % (guard_macro, guard_macro))
+        out.append("typedef enum\n{")
+        for name in self.order:
+            out.append("    %s," % self.state_enum(name))
+        out.append("    %s_NR_OF_STATES,\n} %sState_t;\n" % (self.prefix, self.name[0].upper() + self.name[1:]))
+        if self.events:
+            out.append("typedef enum\n{")
+            for i, event in enumerate(self.events):
+                out.append("    %s%s," % (self.event_enum(event), " = FSM_EVENT_USER" if 0 == i else ""))
+            out.append("} %sEvent_t;\n" % (self.name[0].upper() + self.name[1:]))
+        out.append("#define %s_INIT_STATE  %s\n" % (self.prefix, self.state_enum(self.machine.initial)))
+        if guards or actions or entries or exits:
+            out.append("/* implemented by the application */")
+            out.extend("uint8_t %s(void* context, const FsmEvent_t event);" % f for f in guards)
+            out.extend("void %s(void* context, const FsmEvent_t event);" % f for f in actions)
+            out.extend("void %s(void* context);" % f for f in entries + [e for e in exits if e not in entries])
+            out.append("")
+        out.append("extern const FsmDef_t %sFsmDef;\n" % self.name)
+        out.append("#endif /* %s */" % guard_macro)
+        return "\n".join(out) + "\n"
+
+    def condition(self, transition):
+        return "%s(context, event)" % transition.guard
+
+    def switch_func(self, name):
+        out = ["static uint8_t %s(void* context, const FsmEvent_t event)\n{" % self.state_func(name)]
+        out.append("    uint8_t nextState = FSM_UNHANDLED;\n")
+        if not any(t.action or t.guard for t in self.by_state[name]):
+            out.append("    (void)context;\n")
+        out.append("    switch (event)\n    {")
+        events = collections.OrderedDict()
+        for transition in self.by_state[name]:
+            events.setdefault(transition.event or "TICK", []).append(transition)
+        for event, transitions in events.items():
+            out.append("        case %s:" % self.event_enum(event))
+            indent = "            "
+            for i, transition in enumerate(transitions):
+                body = []
+                if transition.action:
+                    body.append("%s(context, event);" % transition.action)
+                body.append("nextState = %s;" % self.state_enum(transition.next_state))
+                if transition.guard is None:
+                    if i > 0:
+                        out.append(indent + "else\n" + indent + "{")
+                        out.extend(indent + "    " + b for b in body)
+                        out.append(indent + "}")
+                    else:
+                        out.extend(indent + b for b in body)
+                else:
+                    out.append(indent + ("else if" if i > 0 else "if") + " (0 != %s)" % self.condition(transition))
+                    out.append(indent + "{")
+                    out.extend(indent + "    " + b for b in body)
+                    out.append(indent + "}")
+            out.append("            break;")
+        out.append("        default:\n            break;\n    }")
+        out.append("    return nextState;\n}\n")
+        return out
+
+    def source_file(self, base):
+        machine = self.machine
+        n = len(self.order)
+        out = [self.banner(os.path.basename(base) + ".c", "%s state machine" % self.name)]
+        out.append("#include \"%s.h\"\n#include \"stddef.h\"\n" % os.path.basename(base))
+
+        if self.unhandled:
+            out.append("/* states without transitions, keeps them valid next states */")
+            out.append("static uint8_t %sStateUnhandled(void* context, const FsmEvent_t event)\n{" % self.name)
+            out.append("    (void)context;\n    (void)event;\n    return FSM_UNHANDLED;\n}\n")
+        if self.use_switch:
+            for name in self.order:
+                if self.by_state[name]:
+                    out.extend(self.switch_func(name))
+
+        out.append("static const FsmStateDef_t %sStates[%s_NR_OF_STATES] =\n{" % (self.name, self.prefix))
+        for name in self.order:
+            state = machine.states[name]
+            budget = ", FSM_STATE_BUDGET(%dU)" % state.budget if state.budget else ""
+            out.append("    [%s] = { %s, %s, %s, %d%s }," % (self.state_enum(name), self.state_func(name) or "NULL",
+                                                             state.entry or "NULL", state.exit or "NULL",
+                                                             state.timeout, budget))
+        out.append("};\n")
+
+        if not self.use_switch:
+            if self.transitions:
+                out.append("static const FsmTransition_t %sTransitions[] =\n{" % self.name)
+                for t in self.transitions:
+                    out.append("    { %s, %s, %s, %s, %s }," % (self.state_enum(t.state), self.event_enum(t.event),
+                                                             t.guard or "NULL", t.action or "NULL",
+                                                             self.state_enum(t.next_state)))
+                out.append("};\n")
+            index, position = [], 0
+            for name in self.order:
+                index.append(position)
+                position += len(self.by_state[name])
+            index.append(position)
+            out.append("static const uint16_t %sTransitionIndex[%s_NR_OF_STATES + 1] =\n{" % (self.name, self.prefix))
+            out.extend(self.rows(index, 16))
+            out.append("};\n")
+
+        if self.hierarchy:
+            parents = [machine.states[machine.states[name].parent].index if machine.states[name].parent else FSM_UNHANDLED
+                       for name in self.order]
+            out.append("static const uint8_t %sParents[%s_NR_OF_STATES] =\n{" % (self.name, self.prefix))
+            out.extend(self.rows(parents, 16))
+            out.append("};\n")
+            lca = []
+            for a in self.order:
+                chain_a = ancestors(machine, a)
+                for b in self.order:
+                    chain_b = ancestors(machine, b)
+                    common = next((machine.states[s].index for s in chain_a if s in chain_b), FSM_UNHANDLED)
+                    lca.append(common)
+            out.append("static const uint8_t %sLca[%s_NR_OF_STATES * %s_NR_OF_STATES] =\n{" %
+                       (self.name, self.prefix, self.prefix))
+            out.extend(self.rows(lca, n))
+            out.append("};\n")
+
+        out.append("const FsmDef_t %sFsmDef =\n{" % self.name)
+        out.append("    .table = %sStates," % self.name)
+        if not self.use_switch:
+            out.append("    .transitions = %s," % (("%sTransitions" % self.name) if self.transitions else "NULL"))
+            out.append("    .transitionIndex = %sTransitionIndex," % self.name)
+        out.append("    .nrOfStates = %s_NR_OF_STATES," % self.prefix)
+        if self.hierarchy:
+            out.append("    .parents = %sParents," % self.name)
+            out.append("    .lca = %sLca," % self.name)
+        out.append("};")
+        return "\n".join(out) + "\n"
+
+    @staticmethod
+    def rows(values, width):
+        width = max(1, min(width, 16))
+        return ["    " + ", ".join("%d" % v for v in values[i:i + width]) + ","
+                for i in range(0, len(values), width)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a const FSM definition from a state diagram.")
+    parser.add_argument("input", help="mermaid (.mmd, .md), PlantUML (.puml) or SCXML (.scxml) file")
+    parser.add_argument("--name", required=True, help="fsm name (C identifier), e.g. button")
+    parser.add_argument("-o", "--output", required=True, help="output path without extension")
+    parser.add_argument("--hot", default="", help="comma separated states that get the lowest numbers")
+    parser.add_argument("--initial", help="initial state (default: [*] target or first state)")
+    parser.add_argument("--switch", action="store_true", help="switch based state functions instead of a transition table")
+    parser.add_argument("--allow-unreachable", action="store_true", help="warn instead of fail on unreachable states")
+    parser.add_argument("--allow-dead", action="store_true", help="warn instead of fail on dead states")
+    args = parser.parse_args()
+
+    try:
+        check_identifier(args.name, "name", 0)
+        with open(args.input, "r", encoding="utf-8") as f:
+            text = f.read()
+        if text.lstrip().startswith("<"):
+            machine = parse_scxml(text)
+        else:
+            # a markdown file may hold the diagram in a ```mermaid block
+            block = re.search(r"```mermaid\s*\n(.*?)```", text, re.S)
+            machine = parse_text(block.group(1) if block else text)
+        if args.initial:
+            machine.initial = args.initial
+        for warning in validate(machine, args.allow_unreachable, args.allow_dead):
+            print("warning: %s" % warning, file=sys.stderr)
+        order = number_states(machine, [s for s in args.hot.split(",") if s])
+        generator = Generator(machine, order, args.name, args.switch, args.input)
+        header = generator.header(args.output)
+        source = generator.source_file(args.output)
+    except (FsmError, OSError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+
+    with open(args.output + ".h", "w", encoding="utf-8") as f:
+        f.write(header)
+    with open(args.output + ".c", "w", encoding="utf-8") as f:
+        f.write(source)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Decode a binary FSM transition trace (see fsmTrace.h) into a timeline.
+
+Input is either the stream written by fsmTraceDump() or, with --raw, the
+record array of a FsmTrace_t taken from a core dump / memory read. In raw
+mode the write index of the trace has to be given with --write-index so
+the records can be sorted oldest first.
+
+Usage:
+    fsmTraceDecode.py trace.bin
+    fsmTraceDecode.py trace.bin --states protoStates.txt --tick-hz 1000
+    fsmTraceDecode.py records.bin --raw --write-index 1234
+
+The optional states file holds one state name per line, line n is the name
+of state n. Lines of the form "<id> <name>" in an optional instance file
+name the instance ids.
+
+Records are printed in write order. Writers in different interrupts or
+threads take their record index before they read the timestamp, so records
+of different writers can be slightly out of timestamp order. Timestamp
+deltas of 2^31 or more are taken as negative (a record older than the one
+before), the wrap of the 32 bit timestamp is handled for all others.
+
+MIT License, Copyright (c) 2026 CMA
+"""
+
+import argparse
+import struct
+import sys
+
+TRACE_MAGIC = 0x544D5346  # "FSMT"
+TIMESTAMP_MASK = 0xFFFFFFFF
+TIMESTAMP_HALF = 0x80000000
+TRACE_VERSION = 1
+HEADER = struct.Struct("<IHHI")
+RECORD = struct.Struct("<IHBB")
+
+
+def read_names(path):
+    names = []
+    with open(path, "r", encoding="utf-8") as f:
+        for line in f:
+            names.append(line.strip())
+    return names
+
+
+def read_instances(path):
+    instances = {}
+    with open(path, "r", encoding="utf-8") as f:
+        for line in f:
+            parts = line.split(None, 1)
+            if len(parts) == 2:
+                instances[int(parts[0], 0)] = parts[1].strip()
+    return instances
+
+
+def parse_stream(data):
+    if len(data) < HEADER.size:
+        raise ValueError("trace is shorter than the header")
+    magic, version, record_size, count = HEADER.unpack_from(data, 0)
+    if magic != TRACE_MAGIC:
+        raise ValueError("invalid magic 0x%08X" % magic)
+    if version != TRACE_VERSION:
+        raise ValueError("unsupported trace version %d" % version)
+    if record_size != RECORD.size:
+        raise ValueError("unsupported record size %d" % record_size)
+    end = HEADER.size + count * RECORD.size
+    if len(data) < end:
+        raise ValueError("trace is truncated (%d of %d records)" % ((len(data) - HEADER.size) // RECORD.size, count))
+    return [RECORD.unpack_from(data, HEADER.size + i * RECORD.size) for i in range(count)]
+
+
+def parse_raw(data, write_index):
+    size = len(data) // RECORD.size
+    if size == 0 or (size & (size - 1)) != 0:
+        raise ValueError("raw record array must hold a power of two number of records")
+    records = [RECORD.unpack_from(data, i * RECORD.size) for i in range(size)]
+    count = min(write_index, size)
+    return [records[i % size] for i in range(write_index - count, write_index)]
+
+
+def timestamp_delta(timestamp, previous):
+    """Signed difference of two wrapping 32 bit timestamps."""
+    delta = (timestamp - previous) & TIMESTAMP_MASK
+    if delta >= TIMESTAMP_HALF:
+        delta -= TIMESTAMP_MASK + 1
+    return delta
+
+
+def state_name(names, state):
+    if state < len(names) and names[state]:
+        return names[state]
+    return str(state)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a binary FSM transition trace.",
+                                     epilog="Records are printed in write order. Timestamps of records from "
+                                            "different writers (interrupts, threads) are unordered, a record "
+                                            "can have a slightly smaller time than the one before.")
+    parser.add_argument("trace", help="trace file, '-' for stdin")
+    parser.add_argument("--states", help="file with one state name per line")
+    parser.add_argument("--instances", help="file with '<id> <name>' per line")
+    parser.add_argument("--tick-hz", type=float, help="timestamp frequency, prints seconds instead of ticks")
+    parser.add_argument("--raw", action="store_true", help="input is the raw record array of a FsmTrace_t")
+    parser.add_argument("--write-index", type=lambda v: int(v, 0), default=None,
+                        help="write index of the trace (raw mode)")
+    args = parser.parse_args()
+
+    if args.trace == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.trace, "rb") as f:
+            data = f.read()
+
+    try:
+        if args.raw:
+            if args.write_index is None:
+                parser.error("--raw needs --write-index")
+            records = parse_raw(data, args.write_index)
+        else:
+            records = parse_stream(data)
+    except ValueError as error:
+        sys.exit("fsmTraceDecode: %s" % error)
+
+    names = read_names(args.states) if args.states else []
+    instances = read_instances(args.instances) if args.instances else {}
+
+    if not records:
+        return
+
+    # timestamps are 32 bit and may wrap, print them relative to the first record
+    elapsed = 0
+    previous = records[0][0]
+    for timestamp, instance_id, state_from, state_to in records:
+        elapsed += timestamp_delta(timestamp, previous)
+        previous = timestamp
+        if args.tick_hz:
+            time = "%12.6f" % (elapsed / args.tick_hz)
+        else:
+            time = "%12d" % elapsed
+        instance = instances.get(instance_id, str(instance_id))
+        print("%s  %-12s %s -> %s" % (time, instance, state_name(names, state_from), state_name(names, state_to)))
+
+
+if __name__ == "__main__":
+    main()